@@ -10,8 +10,12 @@
 #include <iostream>
 #include <vector>
 #include <set>
+#include <map>
 #include <algorithm>
 
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+
 #include <piranha/piranha.hpp>
 #include <piranha/math.hpp>
 
@@ -58,7 +62,6 @@ namespace SMTPlan
 
 		void addExpression(int opID, std::set<int> deps, pexpr &expr);
 		void createChildren(std::map<int,FunctionFlow*> &allFlows);
-		bool dependenciesResolved(std::map<int,FunctionFlow*> &allFlows);
 		void integrate();
 	};
 
@@ -70,13 +73,17 @@ namespace SMTPlan
 		std::map<std::string, int> function_id_map;
 		std::map<int, std::string> predicate_head_map;
 
+		/* true if every flow, condition and effect is linear */
+		bool linear;
+
 	private:
 
 		enum AlgState
 		{
 			ALG_NONE,
 			ALG_COLLECT_STATICS,
-			ALG_PROCESS_FUNCTIONS
+			ALG_PROCESS_FUNCTIONS,
+			ALG_CHECK_LINEAR
 		};
 
 		AlgState alg_state;
@@ -95,6 +102,23 @@ namespace SMTPlan
 		std::map<int, pexpr> function_var;
 		pexpr hasht{"hasht"};
 
+		/*
+		 * Flows are resolved a level of the dependency graph at a time.
+		 * The flows of a level only read flows of earlier levels, so
+		 * workers take them in any order.
+		 */
+		std::vector<FunctionFlow*> alg_level;
+		unsigned int alg_level_next;
+		boost::mutex alg_level_mutex;
+
+		void orderFlows(std::vector<std::vector<FunctionFlow*> > &levels, std::vector<FunctionFlow*> &cyclic);
+		void resolveLevel(const std::vector<FunctionFlow*> &level);
+		void resolveWorker();
+
+		/* linearity check */
+		bool alg_check_event;
+		bool isLinear(const pexpr &poly, int max_degree);
+
 		/* utility method */
 		void checkFunction(Inst::PNE * const lit) {
 
@@ -126,8 +150,11 @@ namespace SMTPlan
 
 		Algebraist(VAL::analysis* analysis, PlannerOptions &options, ProblemInfo &pi)
 		{
+			opt = &options;
 			problem_info = &pi;
 			val_analysis = analysis;
+			linear = true;
+			alg_check_event = false;
 		}
 
 		~Algebraist()
@@ -136,12 +163,18 @@ namespace SMTPlan
 			for (; it != function_flow.end(); ++it) delete it->second;
 		}
 
-		/* encoding methods */
+		/* encoding methods, false if the continuous effects are cyclic */
 		bool processDomain();
 
 		/* visitor methods */
+		virtual void visit_action(VAL::action * o);
 		virtual void visit_durative_action(VAL::durative_action * da);
 
+		virtual void visit_conj_goal(VAL::conj_goal * c);
+		virtual void visit_neg_goal(VAL::neg_goal * c);
+		virtual void visit_timed_goal(VAL::timed_goal * c);
+		virtual void visit_comparison(VAL::comparison * c);
+
 		virtual void visit_assignment(VAL::assignment * e);
 		virtual void visit_forall_effect(VAL::forall_effect * e);
 		virtual void visit_cond_effect(VAL::cond_effect * e);
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <vector>
 
+#include <boost/thread.hpp>
+
 #include "z3++.h"
 
 #include "ptree.h"
@@ -20,6 +22,8 @@
 #include "SMTPlan/PlannerOptions.h"
 #include "SMTPlan/ProblemInfo.h"
 #include "SMTPlan/Algebraist.h"
+#include "SMTPlan/SolverPortfolio.h"
+#include "SMTPlan/VariableFactory.h"
 
 #ifndef KCL_encoder
 #define KCL_encoder
@@ -43,11 +47,48 @@ namespace SMTPlan
 		ENC_PROCESS_CONDITION
 	};
 
+	/*
+	 * An action that may start at a happening, with the variables
+	 * needed to print it from a model.
+	 */
+	struct PlanStep
+	{
+		int h;
+		std::string action;
+		z3::expr start;
+		z3::expr duration;
+		z3::expr time;
+	};
+
 	class Encoder : public VAL::VisitController
 	{
 	private:
+
+		/* set by interrupt, guarded by interrupt_mutex */
+		boost::mutex interrupt_mutex;
+		bool interrupted;
+
 	public:
 
+		Encoder()
+			: interrupted(false), z3_context(NULL), z3_tactic(NULL), z3_solver(NULL), var_factory(NULL),
+			  z3_portfolio(NULL), z3_model(NULL), owned_problem_info(NULL) {}
+
+		/*
+		 * The expressions held by the derived encoder are destroyed before
+		 * this runs. Everything else made in the context, including the
+		 * static function values of the problem info, must go before it.
+		 */
+		virtual ~Encoder() {
+			if(z3_model) delete z3_model;
+			if(z3_portfolio) delete z3_portfolio;
+			if(z3_solver) delete z3_solver;
+			if(z3_tactic) delete z3_tactic;
+			if(var_factory) delete var_factory;
+			if(owned_problem_info) delete owned_problem_info;
+			if(z3_context) delete z3_context;
+		}
+
 		/* encoding methods */
 		virtual bool encode(int H) =0;
 
@@ -57,12 +98,45 @@ namespace SMTPlan
 		 */
 		virtual void addGoal() =0;
 
+		/* goal expression, passed to the solver as assumptions */
+		virtual std::vector<z3::expr> & getGoal() =0;
+
+		/* the actions of the encoding, in the order printModel prints them */
+		virtual void getPlanSteps(std::vector<PlanStep> &steps) =0;
+
 		/* solving */
 		z3::context * z3_context;
 		z3::tactic * z3_tactic;
 		z3::solver * z3_solver;
+		VariableFactory * var_factory;
 		virtual z3::check_result solve() =0;
 		virtual void printModel() =0;
+
+		/* strategy portfolio, NULL unless several strategies are raced */
+		SolverPortfolio * z3_portfolio;
+
+		/* model of the last race won with sat, otherwise taken from z3_solver */
+		z3::model * z3_model;
+
+		/* problem info copied for this encoder and deleted with it, or NULL */
+		ProblemInfo * owned_problem_info;
+
+		/*
+		 * Cancel solving in progress, may be called from any thread. The
+		 * interrupt is remembered, so that solve returns unknown without
+		 * solving if it is called afterwards.
+		 */
+		void interrupt() {
+			boost::mutex::scoped_lock lock(interrupt_mutex);
+			interrupted = true;
+			z3_context->interrupt();
+			if(z3_portfolio) z3_portfolio->interrupt();
+		}
+
+		bool wasInterrupted() {
+			boost::mutex::scoped_lock lock(interrupt_mutex);
+			return interrupted;
+		}
 	};
 
 } // close namespace
@@ -21,6 +21,7 @@
 #include "SMTPlan/PlannerOptions.h"
 #include "SMTPlan/ProblemInfo.h"
 #include "SMTPlan/Algebraist.h"
+#include "SMTPlan/VarTable.h"
 
 #ifndef KCL_encoder_fluent
 #define KCL_encoder_fluent
@@ -50,7 +51,7 @@ namespace SMTPlan
 		int enc_pneID;
 		int enc_opID;
 		int enc_tilID;
-		std::string enc_op_string;
+		int enc_op_name;
 
 		bool enc_continuous;
 		bool enc_cond_neg;
@@ -61,6 +62,17 @@ namespace SMTPlan
 		VAL::time_spec enc_eff_time;
 		VAL::comparison_op enc_comparison_op;
 
+		/* variable name prefixes */
+		std::vector<int> enc_op_names;
+		std::vector<int> enc_lit_names;
+		std::vector<int> enc_pne_names;
+		std::vector<int> enc_lit_time_names;
+		std::map<int,int> enc_til_names;
+		int enc_time_name;
+		int enc_duration_name;
+		int enc_goal_name;
+		int enc_goal_count;
+
 		/* more encoding state */
 		EncState enc_state;
 		int enc_expression_h;
@@ -96,16 +108,16 @@ namespace SMTPlan
 		std::vector<z3::expr> time_vars;
 		std::vector<z3::expr> duration_vars;
 
-		std::vector<std::vector<std::vector<z3::expr> > > event_cascade_literal_vars;
-		std::vector<std::vector<z3::expr> > literal_time_vars;
+		CascadeVarTable event_cascade_literal_vars;
+		VarTable literal_time_vars;
 
-		std::vector<std::vector<std::vector<z3::expr> > > event_cascade_function_vars;
-		std::map<int, std::vector<std::vector<z3::expr>>> event_vars;
-		std::map<int, std::vector<z3::expr> > sta_action_vars;
-		std::map<int, std::vector<z3::expr> > end_action_vars;
-		std::map<int, std::vector<z3::expr> > dur_action_vars;
-		std::map<int, std::vector<z3::expr> > run_action_vars;
-		std::map<int, std::vector<z3::expr> > til_vars;
+		CascadeVarTable event_cascade_function_vars;
+		CascadeVarTable event_vars;
+		VarTable sta_action_vars;
+		VarTable end_action_vars;
+		VarTable dur_action_vars;
+		VarTable run_action_vars;
+		VarTable til_vars;
 
 		/* encoding methods */
 		void encodeHeader(int H, int L);
@@ -146,7 +158,7 @@ namespace SMTPlan
 				z3::expr coeff = z3_context->real_val(ss.str().c_str());
 
 				// symbols
-				for (int i = 0; i < it->m_key.size(); i++) {
+				for (std::size_t i = 0; i < it->m_key.size(); i++) {
 					if (it->m_key[i] != pexpr(0)) {
 						// default symbol: #t
 						z3::expr sym = duration_vars[h];
@@ -203,16 +215,39 @@ namespace SMTPlan
 
 			initialState = std::vector<bool>(litCount);
 
-			// for each [func|lit] : for each happening : for each cascade level
-			event_cascade_function_vars = std::vector<std::vector<std::vector<z3::expr> > >(pneCount);
-			event_cascade_literal_vars = std::vector<std::vector<std::vector<z3::expr> > >(litCount);
-			literal_time_vars = std::vector<std::vector<z3::expr> >(litCount);
-
 			z3::config cfg;
 			cfg.set("auto_config", true);
 			z3_context = new z3::context(cfg);
-			z3_tactic = new z3::tactic(*z3_context, "qfnra-nlsat");
-			z3_solver = new z3::solver(*z3_context, z3_tactic->mk_solver());
+
+			// readable names are only needed for smt2 output and debugging
+			var_factory = new VariableFactory(*z3_context, opt->debug || !opt->solve);
+			enc_lit_names = std::vector<int>(litCount);
+			enc_pne_names = std::vector<int>(pneCount);
+			enc_lit_time_names = std::vector<int>(litCount);
+			enc_time_name = var_factory->addPrefix("t");
+			enc_duration_name = var_factory->addPrefix("d");
+			enc_goal_name = var_factory->addPrefix("goal_");
+			enc_goal_count = 0;
+
+			// for each [op|func|lit|til] : for each happening (: for each cascade level)
+			const int opCount = Inst::instantiatedOp::howMany();
+			const int tilCount = val_analysis->the_problem->initial_state->timed_effects.size();
+			event_cascade_function_vars = CascadeVarTable(*z3_context, pneCount, opt->cascade_bound);
+			event_cascade_literal_vars = CascadeVarTable(*z3_context, litCount, opt->cascade_bound);
+			literal_time_vars = VarTable(*z3_context, litCount);
+			event_vars = CascadeVarTable(*z3_context, opCount, opt->cascade_bound-1);
+			sta_action_vars = VarTable(*z3_context, opCount);
+			end_action_vars = VarTable(*z3_context, opCount);
+			dur_action_vars = VarTable(*z3_context, opCount);
+			run_action_vars = VarTable(*z3_context, opCount);
+			til_vars = VarTable(*z3_context, tilCount);
+
+			z3_tactic = new z3::tactic(mk_strategy(*z3_context, opt->strategy));
+			z3_solver = new z3::solver(mk_solver(*z3_context, opt->strategy, opt->incremental));
+			z3_model = NULL;
+			z3_portfolio = NULL;
+			if(opt->portfolio.size() > 1)
+				z3_portfolio = new SolverPortfolio(opt->portfolio, opt->incremental);
 		}
 
 		/* encoding methods */
@@ -228,6 +263,10 @@ namespace SMTPlan
 				z3_solver->add(*git);
 		};
 
+		std::vector<z3::expr> & getGoal() { return goal_expression; }
+
+		void getPlanSteps(std::vector<PlanStep> &steps);
+
 		/* visitor methods */
 		virtual void visit_action(VAL::action * o);
 		virtual void visit_durative_action(VAL::durative_action * da);
@@ -21,6 +21,8 @@
 #include "SMTPlan/PlannerOptions.h"
 #include "SMTPlan/ProblemInfo.h"
 #include "SMTPlan/Algebraist.h"
+#include "SMTPlan/VarTable.h"
+#include "SMTPlan/SupportIndex.h"
 
 #ifndef KCL_encoder_happening
 #define KCL_encoder_happening
@@ -48,17 +50,37 @@ namespace SMTPlan
 		int enc_pneID;
 		int enc_opID;
 		int enc_tilID;
-		std::string enc_op_string;
+		int enc_op_name;
 
 		bool enc_continuous;
 		bool enc_cond_neg;
 		bool enc_eff_neg;
-		bool enc_make_op_vars;
 
 		VAL::time_spec enc_cond_time;
 		VAL::time_spec enc_eff_time;
 		VAL::comparison_op enc_comparison_op;
 
+		/* variable name prefixes */
+		std::vector<int> enc_op_names;
+		std::vector<int> enc_lit_names;
+		std::vector<int> enc_pne_names;
+		std::map<int,int> enc_til_names;
+		std::vector<std::vector<int> > enc_mutex_names;
+
+		/* finite-domain state variables, each the binary code of the literal of a group that holds */
+		std::vector<std::vector<int> > enc_domain_literals;
+		std::vector<std::vector<int> > enc_domain_names;
+		std::vector<bool> enc_domain_groups;
+		std::vector<bool> enc_domain_literal;
+
+		/* symmetry breaking: one prefix for each symmetry, and whether the actions are equal so far */
+		std::vector<int> enc_symmetry_names;
+		std::vector<z3::expr> enc_symmetry_equal;
+		int enc_time_name;
+		int enc_duration_name;
+		int enc_goal_name;
+		int enc_goal_count;
+
 		/* more encoding state */
 		EncState enc_state;
 		int enc_expression_h;
@@ -88,27 +110,154 @@ namespace SMTPlan
 		std::vector<bool> initialState;
 		std::vector<int> action_ids;
 
+		/* the effect lists above, indexed once they are complete */
+		SupportIndex event_add_support;
+		SupportIndex event_del_support;
+		SupportIndex start_add_support;
+		SupportIndex start_del_support;
+		SupportIndex end_add_support;
+		SupportIndex end_del_support;
+		SupportIndex til_add_support;
+		SupportIndex til_del_support;
+		SupportIndex event_assign_support;
+		SupportIndex start_assign_support;
+		SupportIndex end_assign_support;
+		SupportIndex til_assign_support;
+
+		/* arguments of the frame axiom being encoded, reused for every axiom */
+		std::vector<Z3_ast> support_args;
+
+		/* a literal condition or effect of an operator */
+		struct LiteralTemplate
+		{
+			int literal;
+			bool negative;
+			VAL::time_spec time;
+		};
+
+		/*
+		 * A node of a numeric expression, in postfix order. Constants index
+		 * template_constants, functions are PNE IDs, and the duration is
+		 * that of the operator being encoded.
+		 */
+		enum ExpressionKind
+		{
+			EXPR_CONSTANT,
+			EXPR_FUNCTION,
+			EXPR_DURATION,
+			EXPR_PLUS,
+			EXPR_MINUS,
+			EXPR_MUL,
+			EXPR_DIV,
+			EXPR_UMINUS
+		};
+
+		struct ExpressionNode
+		{
+			ExpressionKind kind;
+			int id;
+		};
+
+		/* a numeric condition or duration constraint */
+		struct ComparisonTemplate
+		{
+			std::vector<ExpressionNode> lhs;
+			std::vector<ExpressionNode> rhs;
+			VAL::comparison_op op;
+			VAL::time_spec time;
+		};
+
+		/* a discrete numeric effect; continuous effects are left to the flows */
+		struct AssignmentTemplate
+		{
+			int function;
+			VAL::assign_op op;
+			VAL::time_spec time;
+			std::vector<ExpressionNode> value;
+		};
+
+		enum OperatorKind
+		{
+			OP_NONE,
+			OP_ACTION,
+			OP_DURATIVE_ACTION,
+			OP_EVENT,
+			OP_PROCESS
+		};
+
+		/*
+		 * The conditions, effects and duration constraints of an operator,
+		 * compiled by visiting it once. Every layer is encoded from the
+		 * template, without visiting the operator again.
+		 */
+		struct OperatorTemplate
+		{
+			OperatorKind kind;
+			std::vector<LiteralTemplate> conditions;
+			std::vector<ComparisonTemplate> comparisons;
+			std::vector<ComparisonTemplate> duration;
+			std::vector<LiteralTemplate> effects;
+			std::vector<AssignmentTemplate> assignments;
+			OperatorTemplate() : kind(OP_NONE) {}
+		};
+
+		std::vector<OperatorTemplate> op_templates;
+		std::vector<z3::expr> template_constants;
+
+		/* the template and expression being compiled, or NULL when encoding */
+		OperatorTemplate * enc_template;
+		std::vector<ExpressionNode> * enc_template_expression;
+
 
 		/* SMT variables */
 		std::vector<z3::expr> time_vars;
 		std::vector<z3::expr> duration_vars;
-		std::vector<std::vector<std::vector<z3::expr> > > event_cascade_function_vars;
-		std::vector<std::vector<std::vector<z3::expr> > > event_cascade_literal_vars;
-		std::map<int, std::vector<std::vector<z3::expr>>> event_vars;
-		std::map<int, std::vector<z3::expr> > sta_action_vars;
-		std::map<int, std::vector<z3::expr> > end_action_vars;
-		std::map<int, std::vector<z3::expr> > dur_action_vars;
-		std::map<int, std::vector<z3::expr> > run_action_vars;
-		std::map<int, std::vector<z3::expr> > til_vars;
+		CascadeVarTable event_cascade_function_vars;
+		CascadeVarTable event_cascade_literal_vars;
+		CascadeVarTable event_vars;
+		VarTable sta_action_vars;
+		VarTable end_action_vars;
+		VarTable dur_action_vars;
+		VarTable run_action_vars;
+		VarTable til_vars;
 
 		/* encoding methods */
 		void encodeHeader(int H);
 		void encodeTimings(int H);
+		void buildSupportIndex();
 		void encodeLiteralVariableSupport(int H);
 		void encodeFunctionVariableSupport(int H);
 		void encodeFunctionFlows(int H);
+		void encodeMutexGroups(int H);
+		void findStateVariables();
+		void encodeStateVariables(int H);
+		void encodeSymmetryBreaking(int H);
 		void encodeGoalState(int H);
 		void encodeInitialState();
+		void compileOperators();
+		void encodeOperatorVariables(int H);
+		void encodeSimpleAction(const OperatorTemplate &tmpl);
+		void encodeDurativeAction(const OperatorTemplate &tmpl);
+		void encodeEvent(const OperatorTemplate &tmpl);
+		void encodeProcess(const OperatorTemplate &tmpl);
+		void encodeTemplateEffects(const OperatorTemplate &tmpl);
+		void encodeTemplateConditions(const OperatorTemplate &tmpl);
+		void encodeLiteralCondition(int litID);
+		void encodeLiteralEffect(int litID);
+		void encodeComparison(const ComparisonTemplate &cmp);
+		void encodeComparison(const z3::expr &lhs, const z3::expr &rhs, VAL::comparison_op op);
+		void encodeAssignment(int pneID, VAL::assign_op op, const z3::expr &expr);
+		z3::expr mk_template_expr(const std::vector<ExpressionNode> &nodes);
+
+		void mk_template_node(ExpressionKind kind, int id) {
+			ExpressionNode node = {kind, id};
+			enc_template_expression->push_back(node);
+		}
+
+		void mk_template_constant(const z3::expr &value) {
+			template_constants.push_back(value);
+			mk_template_node(EXPR_CONSTANT, template_constants.size() - 1);
+		}
 
 		void parseExpression(VAL::expression * e);
 
@@ -119,6 +268,11 @@ namespace SMTPlan
 			return z3::to_expr(args.ctx(), Z3_mk_or(args.ctx(), array.size(), &(array[0])));
 		}
 
+		/* the arguments must be kept alive by the caller */
+		z3::expr mk_or(const std::vector<Z3_ast> &args) {
+			return z3::to_expr(*z3_context, Z3_mk_or(*z3_context, args.size(), &(args[0])));
+		}
+
 		z3::expr mk_and(z3::expr_vector args) {
 			std::vector<Z3_ast> array;
 			for (unsigned i = 0; i < args.size(); i++) array.push_back(args[i]);
@@ -140,7 +294,7 @@ namespace SMTPlan
 				z3::expr coeff = z3_context->real_val(ss.str().c_str());
 
 				// symbols
-				for (int i = 0; i < it->m_key.size(); i++) {
+				for (std::size_t i = 0; i < it->m_key.size(); i++) {
 					if (it->m_key[i] != pexpr(0)) {
 						// default symbol: #t
 						z3::expr sym = duration_vars[h];
@@ -197,15 +351,41 @@ namespace SMTPlan
 
 			initialState = std::vector<bool>(litCount);
 
-			// for each [func|lit] : for each happening : for each cascade level
-			event_cascade_function_vars = std::vector<std::vector<std::vector<z3::expr> > >(pneCount);
-			event_cascade_literal_vars = std::vector<std::vector<std::vector<z3::expr> > >(litCount);
-
 			z3::config cfg;
 			cfg.set("auto_config", true);
 			z3_context = new z3::context(cfg);
-			z3_tactic = new z3::tactic(*z3_context, "qfnra-nlsat");
-			z3_solver = new z3::solver(*z3_context, z3_tactic->mk_solver());
+
+			// readable names are only needed for smt2 output and debugging
+			var_factory = new VariableFactory(*z3_context, opt->debug || !opt->solve);
+			enc_lit_names = std::vector<int>(litCount);
+			enc_pne_names = std::vector<int>(pneCount);
+			enc_time_name = var_factory->addPrefix("t");
+			enc_duration_name = var_factory->addPrefix("d");
+			enc_goal_name = var_factory->addPrefix("goal_");
+			enc_goal_count = 0;
+
+			// for each [op|func|lit|til] : for each happening (: for each cascade level)
+			const int opCount = Inst::instantiatedOp::howMany();
+			const int tilCount = val_analysis->the_problem->initial_state->timed_effects.size();
+			event_cascade_function_vars = CascadeVarTable(*z3_context, pneCount, opt->cascade_bound);
+			event_cascade_literal_vars = CascadeVarTable(*z3_context, litCount, opt->cascade_bound);
+			event_vars = CascadeVarTable(*z3_context, opCount, opt->cascade_bound-1);
+			sta_action_vars = VarTable(*z3_context, opCount);
+			end_action_vars = VarTable(*z3_context, opCount);
+			dur_action_vars = VarTable(*z3_context, opCount);
+			run_action_vars = VarTable(*z3_context, opCount);
+			til_vars = VarTable(*z3_context, tilCount);
+
+			op_templates = std::vector<OperatorTemplate>(opCount);
+			enc_template = NULL;
+			enc_template_expression = NULL;
+
+			z3_tactic = new z3::tactic(mk_strategy(*z3_context, opt->strategy));
+			z3_solver = new z3::solver(mk_solver(*z3_context, opt->strategy, opt->incremental));
+			z3_model = NULL;
+			z3_portfolio = NULL;
+			if(opt->portfolio.size() > 1)
+				z3_portfolio = new SolverPortfolio(opt->portfolio, opt->incremental);
 		}
 
 		/* encoding methods */
@@ -221,6 +401,10 @@ namespace SMTPlan
 				z3_solver->add(*git);
 		};
 
+		std::vector<z3::expr> & getGoal() { return goal_expression; }
+
+		void getPlanSteps(std::vector<PlanStep> &steps);
+
 		/* visitor methods */
 		virtual void visit_action(VAL::action * o);
 		virtual void visit_durative_action(VAL::durative_action * da);
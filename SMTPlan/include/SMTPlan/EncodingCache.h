@@ -0,0 +1,92 @@
+/**
+ * This file describes the EncodingCache class. This class stores the
+ * encoding of each horizon on disk, keyed by a hash of the domain,
+ * problem and encoding options, so that a later run on the same
+ * problem can solve it without grounding or encoding.
+ */
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "z3++.h"
+
+#include "SMTPlan/PlannerOptions.h"
+#include "SMTPlan/Encoder.h"
+
+#ifndef KCL_encoding_cache
+#define KCL_encoding_cache
+
+namespace SMTPlan
+{
+	/*
+	 * A cache directory holds one directory for each key, and in it
+	 * up to three files for each horizon H:
+	 *   H.smt2    the encoding with the goal asserted
+	 *   H.plan    the logic, and the variables of each PlanStep
+	 *   H.result  "unsat", or "sat" followed by the plan, once solved
+	 * A horizon with a result is not solved again. Unknown results are
+	 * not stored, as another strategy or time limit may decide them.
+	 *
+	 * Grounded operators and flows are not cached. They point into the
+	 * parse tree of the run that made them, and a horizon missing from
+	 * the cache needs a live encoder, which is built from the grounding.
+	 */
+	class EncodingCache
+	{
+	private:
+
+		PlannerOptions * opt;
+
+		/* directory of this key, empty if caching is disabled */
+		std::string path;
+
+		/* the last horizon solved from the cache */
+		z3::context * cache_context;
+		z3::solver * cache_solver;
+		std::vector<PlanStep> cache_steps;
+
+		/* the plan of the last horizon read from its result file */
+		std::string cache_plan;
+
+		std::string horizonFile(int H, const char * extension);
+		bool readPlan(int H, bool &linear);
+
+		static bool readFile(const std::string &file, std::string &contents);
+		static void writeFile(const std::string &file, const std::string &contents);
+
+	public:
+
+		EncodingCache(PlannerOptions &options);
+		~EncodingCache();
+
+		bool enabled() { return path != ""; }
+
+		/* true if the encoding of horizon H is in the cache */
+		bool has(int H);
+
+		/* store the current encoding of encoder as horizon H */
+		void store(int H, Encoder * encoder, bool linear);
+
+		/* store the result of solving horizon H with encoder, and its plan if sat */
+		void storeResult(int H, Encoder * encoder, z3::check_result result);
+
+		/* the stored result of horizon H, or else load and solve it */
+		z3::check_result solve(int H);
+
+		/* print the plan found by the last call to solve */
+		void printModel();
+
+		/* FNV-1a, continuing from hash */
+		static unsigned long long hash(const std::string &data, unsigned long long hash = 14695981039346656037ULL);
+	};
+
+} // close namespace
+
+#endif
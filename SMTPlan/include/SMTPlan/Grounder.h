@@ -0,0 +1,69 @@
+/**
+ * This file describes the Grounder class. This class grounds the
+ * operator schemas of the domain into the VAL operator store, either
+ * one schema after another or several at once in separate threads.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+
+#include "ptree.h"
+#include "instantiation.h"
+#include "typecheck.h"
+
+#include "SMTPlan/PlannerOptions.h"
+
+#ifndef KCL_grounder
+#define KCL_grounder
+
+namespace SMTPlan
+{
+	class Grounder
+	{
+	private:
+
+		/* problem info */
+		PlannerOptions * opt;
+		VAL::analysis * val_analysis;
+		VAL::TypeChecker * type_checker;
+
+		/* one store for each schema, in domain order */
+		std::vector<const VAL::operator_ *> schemas;
+		std::vector<Inst::OpStore> schema_ops;
+		std::vector<Inst::GroundingStats> schema_stats;
+
+		/* next schema to ground, guarded by schema_mutex */
+		boost::mutex schema_mutex;
+		unsigned int next_schema;
+
+		/* arena of the grounding thread, taking the workers' arenas */
+		VAL::Arena * grounding_arena;
+
+		void groundWorker();
+
+	public:
+
+		Grounder(VAL::analysis* analysis, VAL::TypeChecker &tc, PlannerOptions &options)
+		{
+			opt = &options;
+			val_analysis = analysis;
+			type_checker = &tc;
+			next_schema = 0;
+			grounding_arena = NULL;
+		}
+
+		/*
+		 * Ground every operator schema. With opt->ground_threads above one,
+		 * schemas are grounded concurrently into separate stores that are
+		 * merged in domain order, so operator IDs match a serial grounding.
+		 */
+		void ground();
+	};
+
+} // close namespace
+
+#endif
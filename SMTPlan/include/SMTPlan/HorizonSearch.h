@@ -0,0 +1,133 @@
+/**
+ * This file describes the HorizonSearch class. This class
+ * runs the search over the number of happenings, either solving
+ * several horizons at once in separate z3 contexts, or probing
+ * horizons exponentially.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "z3++.h"
+
+#include "ptree.h"
+#include "instantiation.h"
+
+#include "SMTPlan/Encoder.h"
+#include "SMTPlan/EncoderHappening.h"
+#include "SMTPlan/EncoderFluent.h"
+#include "SMTPlan/PlannerOptions.h"
+#include "SMTPlan/ProblemInfo.h"
+#include "SMTPlan/Algebraist.h"
+#include "SMTPlan/Planner.h"
+#include "SMTPlan/EncodingCache.h"
+
+#ifndef KCL_horizon_search
+#define KCL_horizon_search
+
+namespace SMTPlan
+{
+	class HorizonSearch
+	{
+	private:
+
+		/* problem info */
+		PlannerOptions * opt;
+		ProblemInfo problem_info;
+		VAL::analysis * val_analysis;
+		Algebraist * algebraist;
+
+		/*
+		 * If set, VAL state is installed from the planner only while
+		 * creating encoders and encoding, and the caller holds no scope.
+		 */
+		Planner * planner;
+
+		/*
+		 * The grounded operator stores and the algebraist are shared
+		 * and not thread-safe, so encoders are built one at a time.
+		 * Solving is done without holding this lock.
+		 */
+		boost::mutex encode_mutex;
+
+		/* search state, guarded by search_mutex */
+		boost::mutex search_mutex;
+		int next_horizon;
+		int best_horizon;
+		Encoder * best_encoder;
+		std::vector<Encoder *> worker_encoders;
+		std::vector<int> worker_horizons;
+
+		/* the first z3 error that was not caused by an interrupt */
+		std::string worker_error;
+
+		void runWorker(int worker);
+		bool horizonInRange(int H);
+
+		/* encode a horizon in the planner's scope, if there is one */
+		void encodeHorizon(Encoder * encoder, int H);
+
+		/* encode and solve a single horizon */
+		z3::check_result solveHorizon(Encoder * encoder, int H);
+
+	public:
+
+		/* horizons the solver gave up on, which are not ruled out */
+		int undecided;
+
+		/* if set, each horizon's encoding and result are stored in it */
+		EncodingCache * cache;
+
+		/*
+		 * The longest horizon that searchExponential proved to have no
+		 * plan. Any horizon between it and the plan's was undecided.
+		 */
+		int unsat_horizon;
+
+		HorizonSearch(Algebraist * alg, VAL::analysis* analysis, PlannerOptions &options, ProblemInfo &pi, Planner * p = NULL)
+		{
+			planner = p;
+			opt = &options;
+			problem_info = pi;
+			val_analysis = analysis;
+			algebraist = alg;
+
+			next_horizon = options.lower_bound;
+			best_horizon = -1;
+			best_encoder = NULL;
+			undecided = 0;
+			cache = NULL;
+			unsat_horizon = options.lower_bound - 1;
+		}
+
+		/* create an encoder with its own z3 context and problem info */
+		Encoder * createEncoder();
+
+		/*
+		 * Run opt->threads workers, each deepening its own encoder over
+		 * the horizons it is handed. Returns the encoder holding the model
+		 * of the shortest plan and sets horizon, or NULL if there is none.
+		 * The caller deletes the encoder; the other workers' are deleted here.
+		 * A z3 error in any worker is rethrown once the workers stop.
+		 */
+		Encoder * searchParallel(int &horizon);
+
+		/*
+		 * Double the horizon until a plan is found. If opt->minimal is set,
+		 * bisect between the last unsatisfiable and the first satisfiable
+		 * horizon for the shortest plan, stopping at the first horizon
+		 * that is unknown. Returns as searchParallel, but z3 errors are
+		 * rethrown at once, after deleting the encoders.
+		 */
+		Encoder * searchExponential(int &horizon);
+	};
+
+} // close namespace
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * This file describes the MutexGroups class. This class turns the
+ * state-valued property spaces found by TIM into groups of ground
+ * literals of which at most one can hold in any state, such as the
+ * locations of a single vehicle.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "ptree.h"
+#include "instantiation.h"
+#include "FastEnvironment.h"
+#include "TIM.h"
+#include "TimSupport.h"
+
+#include "SMTPlan/PlannerOptions.h"
+#include "SMTPlan/ProblemInfo.h"
+
+#ifndef KCL_mutex_groups
+#define KCL_mutex_groups
+
+namespace SMTPlan
+{
+	class MutexGroups
+	{
+	private:
+
+		/* problem info */
+		PlannerOptions * opt;
+		ProblemInfo * problem_info;
+		VAL::analysis * val_analysis;
+
+		/* true if the predicate has a single TIM signature */
+		static bool singleSignature(VAL::holding_pred_symbol * hps);
+
+	public:
+
+		MutexGroups(VAL::analysis* analysis, PlannerOptions &options, ProblemInfo &pi)
+		{
+			opt = &options;
+			problem_info = &pi;
+			val_analysis = analysis;
+			grouped_literals = 0;
+		}
+
+		int grouped_literals;
+
+		/*
+		 * Fill the mutex groups of the problem info. A group is made for
+		 * each object of each property space whose states have at most
+		 * one property. It is an exactly-one group if no state of the
+		 * space is empty or marks a running durative action, and one of
+		 * its literals holds initially. No groups are made for domains
+		 * with events or timed initial literals.
+		 */
+		void find();
+	};
+
+} // close namespace
+
+#endif
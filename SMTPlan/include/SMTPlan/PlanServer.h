@@ -0,0 +1,113 @@
+/**
+ * This file describes the PlanServer class. This class keeps a planner
+ * process running, reads plan requests from an input stream, solves them
+ * on a pool of worker threads and writes each plan back as it is found.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "z3++.h"
+
+#include "SMTPlan/PlannerOptions.h"
+#include "SMTPlan/Planner.h"
+#include "SMTPlan/HorizonSearch.h"
+
+#ifndef KCL_plan_server
+#define KCL_plan_server
+
+namespace SMTPlan
+{
+	/*
+	 * Each input line is a request "domain problem [options]", numbered
+	 * from 1 in the order read. The options are appended to those the
+	 * server was started with. Each request is answered by a block
+	 *   job N plan
+	 *   <plan, one action per line>
+	 *   job N solved H happenings in S seconds
+	 * or by a single line "job N unsolved ..." or "job N error ...".
+	 * An unsolved line counts the horizons the solver could not decide,
+	 * which are not ruled out. A request without -u is searched up to
+	 * horizon_cap happenings.
+	 * Blocks are written whole, in the order the requests finish.
+	 * The domain is parsed with each problem.
+	 */
+	class PlanServer
+	{
+	public:
+
+		typedef bool (*ArgumentParser)(int argc, char *argv[], PlannerOptions &options);
+
+	private:
+
+		struct Job
+		{
+			int id;
+			std::vector<std::string> args;
+		};
+
+		/* parses the options of a request as for the command line */
+		ArgumentParser parse_arguments;
+		std::vector<std::string> server_args;
+		int workers;
+
+		/* the upper bound of requests that do not give one */
+		int horizon_cap;
+
+		/* requests waiting for a worker, guarded by job_mutex */
+		boost::mutex job_mutex;
+		boost::condition_variable job_ready;
+		std::deque<Job> jobs;
+		bool input_closed;
+
+		/* serialises writing the answers */
+		boost::mutex output_mutex;
+		std::ostream * output;
+
+		boost::thread_group pool;
+		int next_id;
+
+		void start(std::ostream &out);
+		void submit(const std::vector<std::string> &args);
+		void finish();
+
+		void runWorker();
+		void runJob(const Job &job, std::ostream &out);
+		bool parses(const PlannerOptions &options);
+		void writePlan(Encoder * encoder, std::ostream &out);
+
+	public:
+
+		PlanServer(ArgumentParser parser, int worker_count, const std::vector<std::string> &args)
+		{
+			parse_arguments = parser;
+			workers = worker_count < 1 ? 1 : worker_count;
+			horizon_cap = 100;
+			server_args = args;
+			input_closed = false;
+			output = &std::cout;
+			next_id = 1;
+		}
+
+		/* answer requests from in until it is closed */
+		void serve(std::istream &in, std::ostream &out);
+
+		/* answer a request for each problem of the domain */
+		void batch(const std::string &domain, const std::vector<std::string> &problems, std::ostream &out);
+	};
+
+} // close namespace
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * This file describes the Planner class. This class owns the parsed
+ * problem, its grounding and its algebra, so that one process can plan
+ * several problems, one after another or at once in separate threads.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "ptree.h"
+#include "instantiation.h"
+#include "typecheck.h"
+#include "TIM.h"
+
+#include "SMTPlan/PlannerOptions.h"
+#include "SMTPlan/ProblemInfo.h"
+#include "SMTPlan/Algebraist.h"
+#include "SMTPlan/Encoder.h"
+#include "SMTPlan/EncoderHappening.h"
+#include "SMTPlan/EncoderFluent.h"
+#include "SMTPlan/Grounder.h"
+#include "SMTPlan/Reachability.h"
+#include "SMTPlan/MutexGroups.h"
+#include "SMTPlan/Symmetries.h"
+
+#ifndef KCL_planner
+#define KCL_planner
+
+namespace SMTPlan
+{
+	class Planner
+	{
+	private:
+
+		PlannerOptions * opt;
+
+		/*
+		 * VAL keeps the analysis, type checker, TIM analysis and grounded
+		 * stores in globals. Each planner keeps its own, and swaps them
+		 * with the globals while it holds the VAL lock. Inside a scope
+		 * these members hold the state that the scope displaced.
+		 */
+		VAL::analysis * val_analysis;
+		VAL::TypeChecker * val_type_checker;
+		TIM::TIMAnalyser * tim_analyser;
+		Inst::InstantiationState inst_state;
+
+		static boost::mutex val_mutex;
+
+		void swapState();
+
+	public:
+
+		/*
+		 * Holds the VAL lock and installs the state of a planner for its
+		 * lifetime. Parsing, grounding, creating encoders and encoding all
+		 * read VAL state and must be done in a scope. Solving need not be.
+		 * Scopes do not nest.
+		 */
+		class Scope
+		{
+			Planner * planner;
+			boost::mutex::scoped_lock lock;
+		public:
+			Scope(Planner &p) : planner(&p), lock(val_mutex) { planner->swapState(); }
+			~Scope() { planner->swapState(); }
+		};
+
+		Planner(PlannerOptions &options)
+		{
+			opt = &options;
+			val_analysis = NULL;
+			val_type_checker = NULL;
+			tim_analyser = NULL;
+			algebraist = NULL;
+			grounded_ops = 0;
+			pruned_ops = 0;
+			pruned_literals = 0;
+			grouped_literals = 0;
+			symmetric_objects = 0;
+		}
+
+		~Planner();
+
+		/* set by ground */
+		ProblemInfo problem_info;
+		Inst::GroundingStats grounding_stats;
+		int grounded_ops;
+		int pruned_ops;
+		int pruned_literals;
+		int grouped_literals;
+		int symmetric_objects;
+
+		/* set by processDomain */
+		Algebraist * algebraist;
+
+		/* parse and ground the problem, and record its static symbols */
+		void ground();
+
+		/* compute the boundary expressions of continuous change */
+		bool processDomain();
+
+		/* a new encoder of the problem, or NULL if opt->encoder is unknown; call in a scope */
+		Encoder * createEncoder();
+	};
+
+} // close namespace
+
+#endif
@@ -7,6 +7,7 @@
 #define MAX_BITSET 100000
 
 #include <string>
+#include <vector>
 
 namespace SMTPlan
 {
@@ -29,15 +30,33 @@ namespace SMTPlan
 
 		// solving options
 		bool solve;
+		std::string strategy;
+		std::vector<std::string> portfolio;
+		std::string strategy_file;
+		bool incremental;
 
 		// encoding options
 		int encoder;
+		bool reachability;
+		bool layered;
+		bool mutex_groups;
+		bool finite_domain;
+		bool symmetry;
 
 		// iterative deepening
 		int lower_bound;
 		int upper_bound;
 		int cascade_bound;
 		int step_size;
+		bool exponential;
+		bool minimal;
+
+		// parallel search
+		int threads;
+		int ground_threads;
+
+		// encodings stored between runs, empty if not cached
+		std::string cache_dir;
 	};
 
 // close namespace
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 #include"z3++.h"
 
@@ -18,13 +19,48 @@ using pexpr = piranha::polynomial<piranha::rational,piranha::monomial<int>>;
 
 namespace SMTPlan
 {
-	
+	/*
+	 * Literals of which at most one holds in any state, by ID. If
+	 * exactlyOne is set, one of them always holds.
+	 */
+	struct MutexGroup
+	{
+		std::vector<int> literals;
+		bool exactlyOne;
+	};
+
 	struct ProblemInfo
 	{
 		std::map<std::string,bool> staticPredicateMap;
 		std::map<std::string,bool> staticFunctionMap;
 		std::map<int,z3::expr> staticFunctionValues;
 		std::map<int,pexpr> staticFunctionValuesPiranha;
+
+		/* literals that can never become true, by ID */
+		std::set<int> unreachableLiterals;
+
+		/*
+		 * The first happening at which each operator can be applied and
+		 * each literal can be true, by ID. Empty unless computed. Only the
+		 * happening encoder uses them. The bound assumes each happening
+		 * covers at most cascade_bound layers of the planning graph, which
+		 * holds for its cascade levels but is not shown for the fluent
+		 * encoder, whose literals change at their own layers.
+		 */
+		std::vector<int> operatorHappenings;
+		std::vector<int> literalHappenings;
+
+		/*
+		 * Permutations of the operator IDs, each induced by swapping two
+		 * interchangeable objects. Empty unless computed.
+		 */
+		std::vector<std::vector<int> > operatorSymmetries;
+
+		/* mutex groups found from TIM invariants. Empty unless computed. */
+		std::vector<MutexGroup> mutexGroups;
+
+		int firstOperatorHappening(int id) const { return id < (int)operatorHappenings.size() ? operatorHappenings[id] : 0; }
+		int firstLiteralHappening(int id) const { return id < (int)literalHappenings.size() ? literalHappenings[id] : 0; }
 	};
 
 } // close namespace
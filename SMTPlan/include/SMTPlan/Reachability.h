@@ -0,0 +1,140 @@
+/**
+ * This file describes the Reachability class. This class builds a
+ * relaxed planning graph from the initial state, ignoring delete effects
+ * and relaxing each function to an interval of values, and removes the
+ * ground operators that can never be applied before the problem is encoded.
+ * The layer at which each operator and literal first appears bounds the
+ * first happening at which it can occur.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <set>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+#include "ptree.h"
+#include "instantiation.h"
+#include "VisitController.h"
+#include "FastEnvironment.h"
+
+#include "SMTPlan/PlannerOptions.h"
+#include "SMTPlan/ProblemInfo.h"
+
+#ifndef KCL_reachability
+#define KCL_reachability
+
+namespace SMTPlan
+{
+	/* closed interval of the values an expression can take */
+	struct Interval
+	{
+		double lower;
+		double upper;
+	};
+
+	class Reachability : public VAL::VisitController
+	{
+	private:
+
+		enum ReachState
+		{
+			REACH_NONE,
+			REACH_CONDITION,
+			REACH_START_EFFECT,
+			REACH_EFFECT
+		};
+
+		ReachState reach_state;
+
+		/* problem info */
+		PlannerOptions * opt;
+		ProblemInfo * problem_info;
+		VAL::FastEnvironment * fe;
+		VAL::analysis * val_analysis;
+
+		/* relaxed state, indexed by operator, literal and PNE ID */
+		std::vector<bool> reachable_ops;
+		std::vector<bool> reachable_literals;
+		std::vector<Interval> function_bounds;
+		bool reach_changed;
+
+		/* first layer of the planning graph, by operator and literal ID */
+		std::vector<int> op_levels;
+		std::vector<int> literal_levels;
+		int reach_level;
+
+		/* first happening that can be reached in level steps */
+		int happening(int level);
+
+		/* conditions */
+		bool reach_satisfied;
+		bool reach_at_start;
+		std::set<int> reach_start_adds;
+		std::vector<Interval> reach_expression_stack;
+
+		/* effects */
+		VAL::time_spec reach_eff_time;
+
+		void addLiteral(VAL::proposition * prop);
+		void widen(int pneID, const Interval &values);
+
+		static Interval unbounded();
+		static double product(double a, double b);
+
+	public:
+
+		Reachability(VAL::analysis* analysis, PlannerOptions &options, ProblemInfo &pi)
+		{
+			opt = &options;
+			problem_info = &pi;
+			val_analysis = analysis;
+			fe = NULL;
+			reach_state = REACH_NONE;
+		}
+
+		int pruned_ops;
+		int pruned_literals;
+
+		/*
+		 * Computes the relaxed planning graph to a fixed point, removes the
+		 * unreachable operators from the operator store and marks the
+		 * unreachable literals in the problem info. If opt->layered is set,
+		 * also records the first happening of each operator and literal.
+		 */
+		void prune();
+
+		/* visitor methods */
+		virtual void visit_action(VAL::action * o);
+		virtual void visit_durative_action(VAL::durative_action * da);
+		virtual void visit_event(VAL::event * e);
+		virtual void visit_process(VAL::process * p);
+
+		virtual void visit_simple_goal(VAL::simple_goal *);
+		virtual void visit_conj_goal(VAL::conj_goal *);
+		virtual void visit_disj_goal(VAL::disj_goal *);
+		virtual void visit_timed_goal(VAL::timed_goal *);
+		virtual void visit_comparison(VAL::comparison *);
+
+		virtual void visit_effect_lists(VAL::effect_lists * e);
+		virtual void visit_simple_effect(VAL::simple_effect * e);
+		virtual void visit_cond_effect(VAL::cond_effect * e);
+		virtual void visit_timed_effect(VAL::timed_effect * e);
+		virtual void visit_assignment(VAL::assignment * e);
+
+		virtual void visit_plus_expression(VAL::plus_expression * s);
+		virtual void visit_minus_expression(VAL::minus_expression * s);
+		virtual void visit_mul_expression(VAL::mul_expression * s);
+		virtual void visit_div_expression(VAL::div_expression * s);
+		virtual void visit_uminus_expression(VAL::uminus_expression * s);
+		virtual void visit_int_expression(VAL::int_expression * s);
+		virtual void visit_float_expression(VAL::float_expression * s);
+		virtual void visit_special_val_expr(VAL::special_val_expr * s);
+		virtual void visit_func_term(VAL::func_term * s);
+	};
+
+} // close namespace
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * This file describes the SolverPortfolio class. This class
+ * races several z3 strategies on the same encoding, each in its
+ * own context and thread, and keeps the first definitive answer.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+
+#include "z3++.h"
+
+#ifndef KCL_solver_portfolio
+#define KCL_solver_portfolio
+
+namespace SMTPlan
+{
+	/*
+	 * Creates the tactic named by a strategy. A strategy is either a single
+	 * z3 tactic ("qfnra-nlsat", "qflra", "smt", ...) or a pipeline of tactics
+	 * separated by '>', e.g. "simplify>propagate-values>solve-eqs>smt".
+	 */
+	z3::tactic mk_strategy(z3::context &ctx, const std::string &strategy);
+
+	/*
+	 * Creates a solver for a strategy. If incremental is set, a strategy
+	 * naming a logic ("qflra", "qfnra-nlsat", ...) gives z3's solver for
+	 * that logic and "smt" its default solver, both of which keep what they
+	 * learn between checks. Any other strategy is solved with its tactic,
+	 * which starts afresh on every check.
+	 */
+	z3::solver mk_solver(z3::context &ctx, const std::string &strategy, bool incremental);
+
+	/* expands "default" and splits a comma separated list of strategies */
+	std::vector<std::string> parse_portfolio(const std::string &list);
+
+	class SolverPortfolio
+	{
+	private:
+
+		/*
+		 * An entrant keeps its context and solver from one race to the next,
+		 * and is given only the assertions added since. An entrant that was
+		 * interrupted is rebuilt before it races again.
+		 */
+		struct Entrant
+		{
+			std::string strategy;
+			z3::context * context;
+			z3::solver * solver;
+			z3::expr_vector * assumptions;
+			z3::check_result result;
+			unsigned int translated;
+			bool done;
+			bool interrupted;
+		};
+
+		std::vector<std::string> strategies;
+		std::vector<Entrant> entrants;
+		bool incremental;
+
+		/* guards entrants, race_result and cancelled */
+		boost::mutex race_mutex;
+		z3::check_result race_result;
+		int race_winner;
+		bool cancelled;
+
+		void runEntrant(int e);
+		void resetEntrant(Entrant &entrant);
+		void clearEntrants();
+
+	public:
+
+		SolverPortfolio(const std::vector<std::string> &strats, bool incremental_solvers = false)
+		{
+			strategies = strats;
+			incremental = incremental_solvers;
+			cancelled = false;
+			race_winner = -1;
+		}
+
+		~SolverPortfolio() { clearEntrants(); }
+
+		/* the strategy that gave the last definitive answer */
+		std::string winner;
+
+		/*
+		 * Race the strategies on the assertions of solver under the given
+		 * assumptions. If the result is sat, model is set to the winning
+		 * model translated into the context of solver.
+		 */
+		z3::check_result solve(z3::solver &solver, std::vector<z3::expr> &assumptions, z3::model *&model);
+
+		/* cancel a race in progress, may be called from any thread */
+		void interrupt();
+
+		/* remembering the winner between runs */
+		static bool readStrategy(const std::string &path, std::string &strategy);
+		static void writeStrategy(const std::string &path, const std::string &strategy);
+	};
+
+} // close namespace
+
+#endif
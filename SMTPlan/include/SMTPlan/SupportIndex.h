@@ -0,0 +1,67 @@
+/**
+ * This file describes the SupportIndex class. A support index lists,
+ * for each literal or function, the operators or TILs whose effects
+ * can change it. The lists are stored one after another in a single
+ * vector, so the frame axioms of each new layer are encoded by walking
+ * a contiguous range, without searching maps or copying lists.
+ */
+#include <vector>
+#include <map>
+#include <utility>
+
+#include "z3++.h"
+
+#ifndef KCL_support_index
+#define KCL_support_index
+
+namespace SMTPlan
+{
+	class SupportIndex
+	{
+	private:
+
+		/* the supporters of entity e are entries[offsets[e]] to entries[offsets[e+1]-1] */
+		std::vector<int> offsets;
+		std::vector<int> entries;
+
+	public:
+
+		SupportIndex() : offsets(1, 0) {}
+
+		/* build from one list of supporters for each entity */
+		void build(const std::vector<std::vector<int> > &lists)
+		{
+			offsets.assign(lists.size() + 1, 0);
+			for(unsigned int e=0; e<lists.size(); e++)
+				offsets[e+1] = offsets[e] + lists[e].size();
+			entries.clear();
+			entries.reserve(offsets.back());
+			for(unsigned int e=0; e<lists.size(); e++)
+				entries.insert(entries.end(), lists[e].begin(), lists[e].end());
+		}
+
+		/* build from the assignments to each of count entities, keeping the assigners */
+		void build(int count, const std::map<int, std::vector<std::pair<int, z3::expr> > > &lists)
+		{
+			offsets.assign(count + 1, 0);
+			std::map<int, std::vector<std::pair<int, z3::expr> > >::const_iterator it = lists.begin();
+			for(; it != lists.end(); ++it)
+				offsets[it->first+1] = it->second.size();
+			for(int e=0; e<count; e++)
+				offsets[e+1] += offsets[e];
+			entries.resize(offsets.back());
+			for(it = lists.begin(); it != lists.end(); ++it) {
+				for(unsigned int i=0; i<it->second.size(); i++)
+					entries[offsets[it->first] + i] = it->second[i].first;
+			}
+		}
+
+		const int * begin(int e) const { return entries.data() + offsets[e]; }
+		const int * end(int e) const { return entries.data() + offsets[e+1]; }
+
+		bool empty(int e) const { return offsets[e] == offsets[e+1]; }
+	};
+
+} // close namespace
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * This file describes the Symmetries class. This class finds objects
+ * that can be swapped without changing the problem, and records the
+ * permutation of the ground operators that each swap induces, so that
+ * the encoder can break the symmetry.
+ */
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "ptree.h"
+#include "instantiation.h"
+
+#include "SMTPlan/PlannerOptions.h"
+#include "SMTPlan/ProblemInfo.h"
+
+#ifndef KCL_symmetries
+#define KCL_symmetries
+
+namespace SMTPlan
+{
+	class Symmetries
+	{
+	private:
+
+		/* a ground atom: the head symbol followed by its arguments */
+		typedef std::vector<const void *> Atom;
+
+		/* problem info */
+		PlannerOptions * opt;
+		ProblemInfo * problem_info;
+		VAL::analysis * val_analysis;
+
+		/* the initial state and goal, as sets of atoms */
+		std::set<Atom> initial_atoms;
+		std::map<Atom, double> initial_values;
+		std::set<Atom> goal_atoms;
+
+		/* the grounding, as atoms */
+		std::set<Atom> literal_atoms;
+		std::set<Atom> pne_atoms;
+		std::vector<Atom> op_atoms;
+		std::map<Atom, int> op_ids;
+
+		bool collectGoal(const VAL::goal * g);
+		void collectGrounding();
+		static Atom swap(const Atom &atom, const void * a, const void * b);
+		bool interchangeable(const VAL::const_symbol * a, const VAL::const_symbol * b);
+
+		/* the operator permutation of swapping a and b, or false if the grounding is not symmetric */
+		bool permutation(const VAL::const_symbol * a, const VAL::const_symbol * b, std::vector<int> &ops);
+
+	public:
+
+		Symmetries(VAL::analysis* analysis, PlannerOptions &options, ProblemInfo &pi)
+		{
+			opt = &options;
+			problem_info = &pi;
+			val_analysis = analysis;
+			symmetric_objects = 0;
+		}
+
+		int symmetric_objects;
+
+		/*
+		 * Fill the operator symmetries of the problem info. Objects of the
+		 * same type are interchangeable if swapping them maps the initial
+		 * state and goal onto themselves. Each class of interchangeable
+		 * objects o1..ok gives the swaps of o(i) and o(i+1), which
+		 * generate every permutation of the class.
+		 */
+		void find();
+	};
+
+} // close namespace
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * This file describes the variable tables used by the encoders.
+ * A table holds one z3 constant for each entity (operator, literal,
+ * function or TIL), happening and, for cascade tables, cascade level.
+ * Variables are stored contiguously, one layer of happenings after
+ * another, so deepening the encoding only appends to the table.
+ */
+#include <vector>
+
+#include "z3++.h"
+
+#ifndef KCL_var_table
+#define KCL_var_table
+
+namespace SMTPlan
+{
+	class VarTable
+	{
+	protected:
+
+		int entities;
+		int cascade;
+		int layers;
+
+		z3::context * context;
+		std::vector<z3::expr> vars;
+		std::vector<bool> used;
+
+	public:
+
+		VarTable() : entities(0), cascade(1), layers(0), context(NULL) {}
+
+		VarTable(z3::context &ctx, int entity_count, int cascade_count = 1)
+		{
+			entities = entity_count;
+			cascade = cascade_count;
+			layers = 0;
+			context = &ctx;
+			used = std::vector<bool>(entities, false);
+		}
+
+		/*
+		 * Make room for happenings up to H. Cells are filled with a
+		 * placeholder until they are set.
+		 */
+		void addLayers(int H) {
+			if(H <= layers) return;
+			vars.resize(H * entities * cascade, context->bool_val(false));
+			layers = H;
+		}
+
+		void set(int e, int h, const z3::expr &var) { set(e, h, 0, var); }
+		void set(int e, int h, int b, const z3::expr &var) {
+			vars[(h * entities + e) * cascade + b] = var;
+			used[e] = true;
+		}
+
+		z3::expr & at(int e, int h, int b = 0) { return vars[(h * entities + e) * cascade + b]; }
+
+		/* true if any variable of the entity has been set */
+		bool has(int e) const { return used[e]; }
+
+		int size() const { return entities; }
+
+		/* indexing as table[entity][happening] */
+		class Row
+		{
+			VarTable * table;
+			int e;
+		public:
+			Row(VarTable * t, int entity) : table(t), e(entity) {}
+			z3::expr & operator[](int h) { return table->at(e, h); }
+		};
+
+		Row operator[](int e) { return Row(this, e); }
+	};
+
+	class CascadeVarTable : public VarTable
+	{
+	public:
+
+		CascadeVarTable() : VarTable() {}
+		CascadeVarTable(z3::context &ctx, int entity_count, int cascade_count)
+			: VarTable(ctx, entity_count, cascade_count) {}
+
+		/* indexing as table[entity][happening][cascade level] */
+		class Layer
+		{
+			VarTable * table;
+			int e;
+			int h;
+		public:
+			Layer(VarTable * t, int entity, int happening) : table(t), e(entity), h(happening) {}
+			z3::expr & operator[](int b) { return table->at(e, h, b); }
+		};
+
+		class Row
+		{
+			VarTable * table;
+			int e;
+		public:
+			Row(VarTable * t, int entity) : table(t), e(entity) {}
+			Layer operator[](int h) { return Layer(table, e, h); }
+		};
+
+		Row operator[](int e) { return Row(this, e); }
+	};
+
+} // close namespace
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * This file describes the VariableFactory class. This class
+ * creates the z3 constants of an encoding. Constants are named
+ * by integer symbols, and their readable names are only built
+ * when they are printed.
+ */
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "z3++.h"
+
+#ifndef KCL_variable_factory
+#define KCL_variable_factory
+
+namespace SMTPlan
+{
+	class VariableFactory
+	{
+	private:
+
+		/* readable name: prefix, then h, then either "_b" or suffix */
+		struct VariableName
+		{
+			int prefix;
+			int h;
+			int b;
+			const char * suffix;
+		};
+
+		z3::context * context;
+		bool readable;
+
+		std::vector<std::string> prefixes;
+		std::vector<VariableName> variables;
+
+		z3::symbol mk_symbol(int prefix, int h, int b, const char * suffix);
+		std::string mk_name(const VariableName &var) const;
+
+	public:
+
+		/*
+		 * If readable_names is set, constants are given their readable
+		 * names in z3 as well, e.g. for smt2 output and debugging.
+		 */
+		VariableFactory(z3::context &ctx, bool readable_names)
+		{
+			context = &ctx;
+			readable = readable_names;
+		}
+
+		/* register the name of an entity, such as a ground action or literal */
+		int addPrefix(const std::string &prefix);
+		const std::string &getPrefix(int prefix) const { return prefixes[prefix]; }
+
+		/* constants named prefix + h + suffix, where suffix is a string literal */
+		z3::expr mk_bool(int prefix, int h, const char * suffix);
+		z3::expr mk_real(int prefix, int h, const char * suffix);
+
+		/* constants named prefix + h + "_" + b */
+		z3::expr mk_cascade_bool(int prefix, int h, int b);
+		z3::expr mk_cascade_real(int prefix, int h, int b);
+
+		/* readable name of a constant created by this factory */
+		std::string name(const z3::expr &var) const;
+	};
+
+} // close namespace
+
+#endif
@@ -59,16 +59,17 @@ namespace SMTPlan {
 			}
 
 			int depID = *(currentFlow.dependencies.begin());
-			FunctionFlow* dep = allFlows[depID];
+			std::map<int,FunctionFlow*>::iterator depit = allFlows.find(depID);
 			currentFlow.dependencies.erase(currentFlow.dependencies.begin());
 
 			// dependency is constant
-			if(dep->flows.size() == 0) {
+			if(depit == allFlows.end() || depit->second->flows.size() == 0) {
 				flows.push_back(currentFlow);
 				continue;
 			}
 
 			// for each single flow of the dependency
+			FunctionFlow* dep = depit->second;
 			bool dep_op_distinct = true;
 			std::vector<SingleFlow>::iterator fit = dep->flows.begin();
 			for(; fit!=dep->flows.end(); fit++) {
@@ -139,19 +140,6 @@ namespace SMTPlan {
 		integrated = true;
 	}
 
-	bool FunctionFlow::dependenciesResolved(std::map<int,FunctionFlow*> &allFlows) {
-
-		std::vector<SingleFlow>::iterator fit = flows.begin();
-		for(; fit!=flows.end(); fit++) {
-
-			std::set<int>::iterator dit = fit->dependencies.begin();
-			for(; dit!=fit->dependencies.end(); dit++) {
-				if(!allFlows[*dit]->integrated) return false;
-			}
-		}		
-		return true;
-	}
-
 	/*------------*/
 	/* ALGEBRAIST */
 	/*------------*/
@@ -205,40 +193,173 @@ namespace SMTPlan {
 			currOp->forOp()->visit(this);
 		}
 
-		bool allComplete = false;
-		while(!allComplete) {
+		// check conditions and discrete effects for nonlinear terms
+		alg_state = ALG_CHECK_LINEAR;
+		opsItr = Inst::instantiatedOp::opsBegin();
+		for (; opsItr != opsEnd; ++opsItr) {
+			Inst::instantiatedOp * const currOp = *opsItr;
+			fe = currOp->getEnv();
+			currOp->forOp()->visit(this);
+		}
+		if(val_analysis->the_problem->the_goal)
+			val_analysis->the_problem->the_goal->visit(this);
+
+		// TILs are encoded with a product of happening times
+		if(val_analysis->the_problem->initial_state->timed_effects.size() > 0)
+			linear = false;
+
+		// resolve and integrate flows in dependency order
+		std::vector<std::vector<FunctionFlow*> > levels;
+		std::vector<FunctionFlow*> cyclic;
+		orderFlows(levels, cyclic);
+		for(unsigned int l=0; l<levels.size(); l++)
+			resolveLevel(levels[l]);
+
+		/*
+		 * Flows on a cycle form a system of differential equations whose
+		 * solution is not in general a polynomial in #t. Integrating them
+		 * with the others held constant would be unsound, so they are rejected.
+		 */
+		if(cyclic.size() > 0) {
+			std::cerr << "Cyclic dependency between the continuous effects on";
+			for(unsigned int i=0; i<cyclic.size(); i++)
+				std::cerr << " " << cyclic[i]->function_string;
+			std::cerr << " is not supported" << std::endl;
+			return false;
+		}
 
-			allComplete = true;
-			map<int,FunctionFlow*>::iterator fit = function_flow.begin();
+		// check integrated flows
+		map<int,FunctionFlow*>::iterator fit = function_flow.begin();
+		for (; fit != function_flow.end(); ++fit) {
+			std::vector<SingleFlow>::iterator sit = fit->second->flows.begin();
+			for(; sit!=fit->second->flows.end(); sit++) {
+				if(!isLinear(sit->polynomial, 1)) linear = false;
+			}
+		}
 
-			for (; fit != function_flow.end(); ++fit) {
+		return true;
+	}
 
-				// check completed
-				if(fit->second->integrated) {
-					continue;
+	/**
+	 * Splits the flows into levels with Kahn's algorithm: a flow is in the
+	 * level after the last of its dependencies. Flows left over depend on
+	 * themselves through a cycle.
+	 */
+	void Algebraist::orderFlows(std::vector<std::vector<FunctionFlow*> > &levels, std::vector<FunctionFlow*> &cyclic) {
+
+		std::map<int, int> waiting;
+		std::map<int, std::vector<int> > dependents;
+		std::vector<FunctionFlow*> current;
+
+		map<int,FunctionFlow*>::iterator fit = function_flow.begin();
+		for (; fit != function_flow.end(); ++fit) {
+
+			std::set<int> deps;
+			std::vector<SingleFlow>::iterator sit = fit->second->flows.begin();
+			for(; sit!=fit->second->flows.end(); sit++)
+				deps.insert(sit->dependencies.begin(), sit->dependencies.end());
+
+			waiting[fit->first] = 0;
+			std::set<int>::iterator dit = deps.begin();
+			for(; dit!=deps.end(); dit++) {
+				if(function_flow.find(*dit) == function_flow.end()) continue;
+				dependents[*dit].push_back(fit->first);
+				waiting[fit->first]++;
+			}
+			if(waiting[fit->first] == 0) current.push_back(fit->second);
+		}
+
+		while(current.size() > 0) {
+			levels.push_back(current);
+			std::vector<FunctionFlow*> next;
+			for(unsigned int i=0; i<current.size(); i++) {
+				std::vector<int> &deps = dependents[current[i]->f_id];
+				for(unsigned int d=0; d<deps.size(); d++) {
+					if(--waiting[deps[d]] == 0) next.push_back(function_flow[deps[d]]);
 				}
+			}
+			current = next;
+		}
 
-				// std::cout << fit->first << std::endl;
+		std::map<int, int>::iterator wit = waiting.begin();
+		for(; wit!=waiting.end(); wit++) {
+			if(wit->second > 0) cyclic.push_back(function_flow[wit->first]);
+		}
+	}
 
-				// check dependencies
-				if(!fit->second->dependenciesResolved(function_flow)) {
-					allComplete = false;
-					continue;
-				}
-				fit->second->createChildren(function_flow);
-				fit->second->integrate();
+	void Algebraist::resolveLevel(const std::vector<FunctionFlow*> &level) {
+
+		alg_level = level;
+		alg_level_next = 0;
+
+		unsigned int threads = boost::thread::hardware_concurrency();
+		if(threads > level.size()) threads = level.size();
+		if(threads <= 1) {
+			resolveWorker();
+			return;
+		}
+
+		boost::thread_group workers;
+		for(unsigned int w=0; w<threads; w++)
+			workers.create_thread(boost::bind(&Algebraist::resolveWorker, this));
+		workers.join_all();
+	}
+
+	void Algebraist::resolveWorker() {
+		while(true) {
+			FunctionFlow * ff;
+			{
+				boost::mutex::scoped_lock lock(alg_level_mutex);
+				if(alg_level_next >= alg_level.size()) return;
+				ff = alg_level[alg_level_next++];
+			}
+			ff->createChildren(function_flow);
+			ff->integrate();
+		}
+	}
+
+	/**
+	 * A polynomial is linear if no term has a total degree above max_degree
+	 * and no symbol has a negative exponent. Static functions have already
+	 * been replaced by their values, so the symbols are #t, ?duration and
+	 * the non-static functions.
+	 */
+	bool Algebraist::isLinear(const pexpr &poly, int max_degree) {
+
+		auto it = poly._container().begin();
+		auto end = poly._container().end();
+		for (; it != end; ++it) {
+			int degree = 0;
+			for (std::size_t i = 0; i < it->m_key.size(); i++) {
+				if(it->m_key[i] < 0) return false;
+				degree += it->m_key[i];
 			}
+			if(degree > max_degree) return false;
 		}
+		return true;
 	}
 
 	/*-------------------------*/
 	/* operators and processes */
 	/*-------------------------*/
 
+	/**
+	 * Visit an instantaneous action, which has no continuous effects
+	 */
+	void Algebraist::visit_action(VAL::action * o) {
+		if(alg_state != ALG_CHECK_LINEAR) return;
+		if(o->precondition) o->precondition->visit(this);
+		o->effects->visit(this);
+	}
+
 	/**
 	 * Visit an operator in order to process its continuous effects
 	 */
 	void Algebraist::visit_durative_action(VAL::durative_action * da) {
+		if(alg_state == ALG_CHECK_LINEAR) {
+			if(da->dur_constraint) da->dur_constraint->visit(this);
+			if(da->precondition) da->precondition->visit(this);
+		}
 		da->effects->visit(this);
 	}
 
@@ -246,9 +367,61 @@ namespace SMTPlan {
 	 * Visit a PDDL process in order to process its continuous effects
 	 */
     void Algebraist::visit_process(VAL::process * p){
+		if(alg_state == ALG_CHECK_LINEAR) {
+			alg_check_event = true;
+			if(p->precondition) p->precondition->visit(this);
+			alg_check_event = false;
+		}
 		p->effects->visit(this);
 	}
 
+	/**
+	 * Visit a PDDL event, which has no continuous effects
+	 */
+	void Algebraist::visit_event(VAL::event * e) {
+		if(alg_state != ALG_CHECK_LINEAR) return;
+		alg_check_event = true;
+		if(e->precondition) e->precondition->visit(this);
+		alg_check_event = false;
+		e->effects->visit(this);
+	}
+
+	/*------------*/
+	/* conditions */
+	/*------------*/
+
+	void Algebraist::visit_conj_goal(VAL::conj_goal * c) {
+		c->getGoals()->visit(this);
+	}
+
+	void Algebraist::visit_timed_goal(VAL::timed_goal * c) {
+		c->getGoal()->visit(this);
+	}
+
+	void Algebraist::visit_neg_goal(VAL::neg_goal * c) {
+		c->getGoal()->visit(this);
+	}
+
+	/**
+	 * Numeric conditions of events and processes are encoded as the product
+	 * of their values at consecutive happenings, so must be constant to be linear.
+	 */
+	void Algebraist::visit_comparison(VAL::comparison * c) {
+
+		if(alg_state != ALG_CHECK_LINEAR) return;
+
+		c->getLHS()->visit(this);
+		c->getRHS()->visit(this);
+
+		pexpr rhs = alg_expression_stack.back();
+		alg_expression_stack.pop_back();
+		pexpr lhs = alg_expression_stack.back();
+		alg_expression_stack.pop_back();
+		alg_dependency_stack.clear();
+
+		if(!isLinear(lhs - rhs, alg_check_event ? 0 : 1)) linear = false;
+	}
+
 	/*---------*/
 	/* effects */
 	/*---------*/
@@ -268,6 +441,29 @@ namespace SMTPlan {
 
 	void Algebraist::visit_assignment(VAL::assignment * e) {
 
+		if(alg_state == ALG_CHECK_LINEAR) {
+
+			alg_is_continuous = false;
+			e->getExpr()->visit(this);
+			pexpr expr = alg_expression_stack.back();
+			alg_expression_stack.pop_back();
+			alg_dependency_stack.clear();
+
+			// continuous effects are checked once integrated
+			if(alg_is_continuous) return;
+
+			switch(e->getOp()) {
+			case VAL::E_SCALE_UP:
+			case VAL::E_SCALE_DOWN:
+				if(!isLinear(expr, 0)) linear = false;
+				break;
+			default:
+				if(!isLinear(expr, 1)) linear = false;
+				break;
+			}
+			return;
+		}
+
 		Inst::PNE * l = new Inst::PNE(e->getFTerm(), fe);	
 		Inst::PNE * const lit = Inst::instantiatedOp::findPNE(l);
 
@@ -305,8 +501,8 @@ namespace SMTPlan {
 		delete l;
 	}
 
-	void Algebraist::visit_forall_effect(VAL::forall_effect * e) {std::cout << "not implemented forall" << std::endl;};
-	void Algebraist::visit_cond_effect(VAL::cond_effect * e) {std::cout << "not implemented cond" << std::endl;};
+	void Algebraist::visit_forall_effect(VAL::forall_effect * e) {if(alg_state != ALG_CHECK_LINEAR) std::cerr << "not implemented forall" << std::endl;};
+	void Algebraist::visit_cond_effect(VAL::cond_effect * e) {if(alg_state != ALG_CHECK_LINEAR) std::cerr << "not implemented cond" << std::endl;};
 
 	/*-------------*/
 	/* expressions */
@@ -361,6 +557,13 @@ namespace SMTPlan {
 		pexpr lhs = alg_expression_stack.back();
 		alg_expression_stack.pop_back();
 
+		// only division by a constant can be inverted
+		if(alg_state == ALG_CHECK_LINEAR && !rhs.is_single_coefficient()) {
+			linear = false;
+			alg_expression_stack.push_back(lhs);
+			return;
+		}
+
 		alg_expression_stack.push_back(lhs * piranha::math::pow(rhs,-1));		
 	}
 
@@ -427,7 +630,6 @@ namespace SMTPlan {
 
 	void Algebraist::visit_timed_initial_literal(VAL::timed_initial_literal * til) {};
 	void Algebraist::visit_preference(VAL::preference *){}
-	void Algebraist::visit_event(VAL::event * e){}
 	void Algebraist::visit_derivation_rule(VAL::derivation_rule * o){}
 
 }; // close namespace
@@ -7,15 +7,33 @@ namespace SMTPlan {
 	 * attempt to solve the encoding
 	 */
 	z3::check_result EncoderFluent::solve() {
+		if(wasInterrupted())
+			return z3::unknown;
+		if(z3_portfolio)
+			return z3_portfolio->solve(*z3_solver, goal_expression, z3_model);
 		z3::check_result result = z3_solver->check(goal_expression.size(), &(*goal_expression.begin()));
 		return result;
 	}
 
+	/**
+	 * lists the start of each action at each happening, for the encoding cache
+	 */
+	void EncoderFluent::getPlanSteps(std::vector<PlanStep> &steps) {
+		for(int h=0; h<upper_bound; h++) {
+			std::vector<int>::iterator ait = action_ids.begin();
+			for(; ait != action_ids.end(); ait++) {
+				PlanStep step = {h, var_factory->name(sta_action_vars[*ait][h]),
+						sta_action_vars[*ait][h], dur_action_vars[*ait][h], time_vars[h]};
+				steps.push_back(step);
+			}
+		}
+	}
+
 	/**
 	 * prints the current model if there is one
 	 */
 	void EncoderFluent::printModel() {
-		z3::model m = z3_solver->get_model();
+		z3::model m = z3_model ? *z3_model : z3_solver->get_model();
 		z3::expr t = z3_context->bool_val(true);
 		z3::set_param("pp.decimal", true);
 		//print plan
@@ -24,7 +42,7 @@ namespace SMTPlan {
 			std::vector<int>::iterator ait = action_ids.begin();
 			for(; ait != action_ids.end(); ait++) {
 				z3::expr v = m.eval(sta_action_vars[*ait][h]);
-				if(eq(v,t))	std::cout << m.eval(time_vars[h]) << ":\t" << sta_action_vars[*ait][h] << " [" << m.eval(dur_action_vars[*ait][h]) << "]" << std::endl;
+				if(eq(v,t))	std::cout << m.eval(time_vars[h]) << ":\t" << var_factory->name(sta_action_vars[*ait][h]) << " [" << m.eval(dur_action_vars[*ait][h]) << "]" << std::endl;
 			}
 
 			if(opt->debug) {
@@ -32,7 +50,7 @@ namespace SMTPlan {
 				// run
 				ait = action_ids.begin();
 				for(; ait != action_ids.end(); ait++) {
-					if(run_action_vars.find(*ait)==run_action_vars.end()) continue;
+					if(!run_action_vars.has(*ait)) continue;
 					z3::expr v = m.eval(run_action_vars[*ait][h]);
 					if(eq(v,t))	std::cout << m.eval(time_vars[h]) << ":\t" << run_action_vars[*ait][h] << "\t(running)" << std::endl;
 				}
@@ -40,15 +58,14 @@ namespace SMTPlan {
 				// end
 				ait = action_ids.begin();
 				for(; ait != action_ids.end(); ait++) {
-					if(end_action_vars.find(*ait)==end_action_vars.end()) continue;
+					if(!end_action_vars.has(*ait)) continue;
 					z3::expr v = m.eval(end_action_vars[*ait][h]);
 					if(eq(v,t))	std::cout << m.eval(time_vars[h]) << ":\t" << end_action_vars[*ait][h] << "\t(end)" << std::endl;
 				}
 
-				std::vector<std::vector<std::vector<z3::expr> > >::iterator fit = event_cascade_function_vars.begin();
-				for(; fit != event_cascade_function_vars.end(); fit++) {
+				for(int f=0; f<event_cascade_function_vars.size(); f++) {
 					for(int b=0; b<opt->cascade_bound; b++) {
-						std::cout << m.eval(time_vars[h]) << ":\t" << (*fit)[h][b] << " == " << m.eval((*fit)[h][b]) << std::endl;
+						std::cout << m.eval(time_vars[h]) << ":\t" << event_cascade_function_vars[f][h][b] << " == " << m.eval(event_cascade_function_vars[f][h][b]) << std::endl;
 					}
 				}
 			}
@@ -91,16 +108,25 @@ namespace SMTPlan {
 
 		encodeGoalState(H, literal_bound);
 
-		// action constraints
-		enc_make_op_vars = true;
+		// operator names, printed once for all layers
 		Inst::OpStore::iterator opsItr = Inst::instantiatedOp::opsBegin();
 		Inst::OpStore::iterator opsEnd = Inst::instantiatedOp::opsEnd();
+		if(enc_op_names.empty()) {
+			enc_op_names.resize(Inst::instantiatedOp::howMany());
+			for (; opsItr != opsEnd; ++opsItr) {
+				std::stringstream ss;
+				ss << (**opsItr);
+				enc_op_names[(*opsItr)->getID()] = var_factory->addPrefix(ss.str());
+			}
+		}
+
+		// action constraints
+		enc_make_op_vars = true;
+		opsItr = Inst::instantiatedOp::opsBegin();
 		for (; opsItr != opsEnd; ++opsItr) {
 			Inst::instantiatedOp * const currOp = *opsItr;
 		    enc_opID = currOp->getID();
-			std::stringstream ss;
-			ss << (*currOp);
-			enc_op_string = ss.str();
+			enc_op_name = enc_op_names[enc_opID];
 			fe = currOp->getEnv();
 			currOp->forOp()->visit(this);
 		}
@@ -111,9 +137,7 @@ namespace SMTPlan {
 		for (; opsItr != opsEnd; ++opsItr) {
 			Inst::instantiatedOp * const currOp = *opsItr;
 		    enc_opID = currOp->getID();
-			std::stringstream ss;
-			ss << (*currOp);
-			enc_op_string = ss.str();
+			enc_op_name = enc_op_names[enc_opID];
 			fe = currOp->getEnv();
 			currOp->forOp()->visit(this);
 		}
@@ -149,14 +173,21 @@ namespace SMTPlan {
 
 	void EncoderFluent::encodeHeader(int H, int L) {
 
+		// make room for the new layers
+		event_cascade_function_vars.addLayers(H);
+		event_cascade_literal_vars.addLayers(L);
+		literal_time_vars.addLayers(L);
+		event_vars.addLayers(H);
+		sta_action_vars.addLayers(H);
+		end_action_vars.addLayers(H);
+		dur_action_vars.addLayers(H);
+		run_action_vars.addLayers(H);
+		til_vars.addLayers(H);
+
 		// timings
 		for(int h=next_layer; h<H; h++) {
-			std::stringstream ss1;
-			ss1 << "t" << h;
-			time_vars.push_back(z3_context->real_const(ss1.str().c_str()));
-			std::stringstream ss2;
-			ss2 << "d" << h;
-			duration_vars.push_back(z3_context->real_const(ss2.str().c_str()));
+			time_vars.push_back(var_factory->mk_real(enc_time_name, h, ""));
+			duration_vars.push_back(var_factory->mk_real(enc_duration_name, h, ""));
 		}
 
 		// literals
@@ -175,23 +206,21 @@ namespace SMTPlan {
 				simpleTILAddEffects[currLit->getID()];
 				simpleTILDelEffects[currLit->getID()];
 
-				event_cascade_literal_vars[currLit->getID()];
-				literal_time_vars[currLit->getID()];
 
-				// one SMT var for each fluent*change
+				std::stringstream ss;
+				ss << (*currLit);
+				enc_lit_names[currLit->getID()] = var_factory->addPrefix(ss.str());
+				enc_lit_time_names[currLit->getID()] = var_factory->addPrefix("timeof_" + ss.str());
+
+				// one SMT var for each fluent*change, literals that can never be true are constant
+				bool unreachable = problem_info->unreachableLiterals.count(currLit->getID()) > 0;
 				for(int l=0; l<L; l++) {
 
-					std::vector<z3::expr> literalVars;
 					for(int b=0; b<opt->cascade_bound; b++) {
-						std::stringstream ss;
-						ss << (*currLit) << l << "_" << b;
-						literalVars.push_back(z3_context->bool_const(ss.str().c_str()));
+						event_cascade_literal_vars.set(currLit->getID(), l, b, unreachable ? z3_context->bool_val(false)
+								: var_factory->mk_cascade_bool(enc_lit_names[currLit->getID()], l, b));
 					}
-					event_cascade_literal_vars[currLit->getID()].push_back(literalVars);
-
-					std::stringstream ss;
-					ss << "timeof_" << (*currLit) << l;
-					literal_time_vars[currLit->getID()].push_back(z3_context->real_const(ss.str().c_str()));
+					literal_time_vars.set(currLit->getID(), l, var_factory->mk_real(enc_lit_time_names[currLit->getID()], l, ""));
 				}
 			}
 		}
@@ -203,17 +232,16 @@ namespace SMTPlan {
 			Inst::PNE * const currPNE = *pneItr;
 
 			if(next_layer == 0) {
-				event_cascade_literal_vars[currPNE->getID()];
+
+				std::stringstream ss;
+				ss << (*currPNE);
+				enc_pne_names[currPNE->getID()] = var_factory->addPrefix(ss.str());
 			}
 
 			for(int h=next_layer; h<H; h++) {
-				std::vector<z3::expr> functionVars;
 				for(int b=0; b<opt->cascade_bound; b++) {
-					std::stringstream ss;
-					ss << (*currPNE) << h << "_" << b;
-					functionVars.push_back(z3_context->real_const(ss.str().c_str()));
+					event_cascade_function_vars.set(currPNE->getID(), h, b, var_factory->mk_cascade_real(enc_pne_names[currPNE->getID()], h, b));
 				}
-				event_cascade_function_vars[currPNE->getID()].push_back(functionVars);
 			}
 		}
 	}
@@ -340,16 +368,18 @@ namespace SMTPlan {
 
 	void EncoderFluent::visit_timed_initial_literal(VAL::timed_initial_literal * til) {
 
-		til_vars[enc_tilID];
+		if(enc_til_names.find(enc_tilID) == enc_til_names.end()) {
+			std::stringstream ss;
+			ss << "til_" << enc_tilID << "_";
+			enc_til_names[enc_tilID] = var_factory->addPrefix(ss.str());
+		}
 
 		for(int h=next_layer; h<upper_bound; h++) {
 
 			// MAKE VARS
-			std::stringstream ss;
-			ss << "til_" << enc_tilID << "_" << h;
-			til_vars[enc_tilID].push_back(z3_context->bool_const(ss.str().c_str()));
-			ss.str("");
+			til_vars.set(enc_tilID, h, var_factory->mk_bool(enc_til_names[enc_tilID], h, ""));
 
+			std::stringstream ss;
 			ss << til->time_stamp;
 			z3::expr time_value = z3_context->real_val(ss.str().c_str());
 
@@ -386,10 +416,6 @@ namespace SMTPlan {
 
 		if(enc_make_op_vars)
 		{
-			sta_action_vars[enc_opID];
-			run_action_vars[enc_opID];
-			end_action_vars[enc_opID];
-			dur_action_vars[enc_opID];
 
 			// remember which operators are actions and not processes
 			if(next_layer==0) {
@@ -399,18 +425,10 @@ namespace SMTPlan {
 			for(int h=next_layer; h<upper_bound; h++) {
 
 				// MAKE VARS
-				std::stringstream ss;
-				ss << enc_op_string << h << "_sta";
-				sta_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_end";
-				end_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_run";
-				run_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_dur";
-				dur_action_vars[enc_opID].push_back(z3_context->real_const(ss.str().c_str()));
+				sta_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_sta"));
+				end_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_end"));
+				run_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_run"));
+				dur_action_vars.set(enc_opID, h, var_factory->mk_real(enc_op_name, h, "_dur"));
 		
 				// running action/process iff (remaining duration > 0)
 				z3_solver->add(run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] > 0));
@@ -471,8 +489,6 @@ namespace SMTPlan {
 
 		if(enc_make_op_vars)
 		{
-			sta_action_vars[enc_opID];
-			dur_action_vars[enc_opID];
 
 			// remember which operators are actions and not processes
 			if(next_layer==0) {
@@ -482,12 +498,8 @@ namespace SMTPlan {
 			for(int h=next_layer; h<upper_bound; h++) {
 			
 				// MAKE VARS
-				std::stringstream ss;
-				ss << enc_op_string << h << "_sta";
-				sta_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_dur";
-				dur_action_vars[enc_opID].push_back(z3_context->real_const(ss.str().c_str()));
+				sta_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_sta"));
+				dur_action_vars.set(enc_opID, h, var_factory->mk_real(enc_op_name, h, "_dur"));
 
 				// (duration == 0)
 				z3_solver->add(dur_action_vars[enc_opID][h] == 0);
@@ -524,17 +536,12 @@ namespace SMTPlan {
 
 		if(enc_make_op_vars)
 		{
-			event_vars[enc_opID];
 
 			for(int h=next_layer; h<upper_bound; h++) {
 				// MAKE VARS
-				std::vector<z3::expr> eventVars;
 				for(enc_expression_b=0; enc_expression_b<opt->cascade_bound-1; enc_expression_b++) {
-					std::stringstream ss;
-					ss << enc_op_string << h << "_" << enc_expression_b;
-					eventVars.push_back(z3_context->bool_const(ss.str().c_str()));
+					event_vars.set(enc_opID, h, enc_expression_b, var_factory->mk_cascade_bool(enc_op_name, h, enc_expression_b));
 				}
-				event_vars[enc_opID].push_back(eventVars);
 			}
 		}
 		else
@@ -607,26 +614,14 @@ namespace SMTPlan {
 		enc_expression_l = 0;
 		if(enc_make_op_vars)
 		{
-			sta_action_vars[enc_opID];
-			run_action_vars[enc_opID];
-			end_action_vars[enc_opID];
-			dur_action_vars[enc_opID];
 
 			for(int h=next_layer; h<upper_bound; h++) {
 			
 				// MAKE VARS
-				std::stringstream ss;
-				ss << enc_op_string << h << "_sta";
-				sta_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_end";
-				end_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_run";
-				run_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_dur";
-				dur_action_vars[enc_opID].push_back(z3_context->real_const(ss.str().c_str()));
+				sta_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_sta"));
+				end_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_end"));
+				run_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_run"));
+				dur_action_vars.set(enc_opID, h, var_factory->mk_real(enc_op_name, h, "_dur"));
 		
 				// running action/process iff (remaining duration > 0)
 				z3_solver->add(run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] > 0));
@@ -1171,9 +1166,7 @@ namespace SMTPlan {
 
 		case ENC_GOAL:
 			{
-				std::stringstream ss;
-				ss << com;
-				z3::expr g = z3_context->bool_const(ss.str().c_str());
+				z3::expr g = var_factory->mk_bool(enc_goal_name, enc_goal_count++, "");
 				z3_solver->add(implies(g,com));
 				goal_expression.push_back(g);
 			}
@@ -1478,8 +1471,8 @@ namespace SMTPlan {
 		delete l;
 	}
 
-	void EncoderFluent::visit_forall_effect(VAL::forall_effect * e) {std::cout << "not implemented forall" << std::endl;};
-	void EncoderFluent::visit_cond_effect(VAL::cond_effect * e) {std::cout << "not implemented cond" << std::endl;};
+	void EncoderFluent::visit_forall_effect(VAL::forall_effect * e) {std::cerr << "not implemented forall" << std::endl;};
+	void EncoderFluent::visit_cond_effect(VAL::cond_effect * e) {std::cerr << "not implemented cond" << std::endl;};
 
 	/*-------------*/
 	/* expressions */
@@ -8,15 +8,34 @@ namespace SMTPlan {
 	 * attempt to solve the encoding
 	 */
 	z3::check_result EncoderHappening::solve() {
+		if(wasInterrupted())
+			return z3::unknown;
+		if(z3_portfolio)
+			return z3_portfolio->solve(*z3_solver, goal_expression, z3_model);
 		z3::check_result result = z3_solver->check(goal_expression.size(), &(*goal_expression.begin()));
 		return result;
 	}
 
+	/**
+	 * lists the start of each action at each happening, for the encoding cache
+	 */
+	void EncoderHappening::getPlanSteps(std::vector<PlanStep> &steps) {
+		for(int h=0; h<upper_bound; h++) {
+			std::vector<int>::iterator ait = action_ids.begin();
+			for(; ait != action_ids.end(); ait++) {
+				std::string a = var_factory->name(sta_action_vars[*ait][h]);
+				PlanStep step = {h, a.substr(a.find("("), a.find(")")-a.find("(")+1),
+						sta_action_vars[*ait][h], dur_action_vars[*ait][h], time_vars[h]};
+				steps.push_back(step);
+			}
+		}
+	}
+
 	/**
 	 * prints the current model if there is one
 	 */
 	void EncoderHappening::printModel() {
-		z3::model m = z3_solver->get_model();
+		z3::model m = z3_model ? *z3_model : z3_solver->get_model();
 		z3::expr t = z3_context->bool_val(true);
 		z3::set_param("pp.decimal", true);
 		//print plan
@@ -30,9 +49,7 @@ namespace SMTPlan {
 					// time
 					std::cout << m.eval(time_vars[h]) << ":\t";
 					// action
-					std::stringstream ss;
-					ss << sta_action_vars[*ait][h];
-					std::string a = ss.str();
+					std::string a = var_factory->name(sta_action_vars[*ait][h]);
 					std::cout << a.substr(a.find("("), a.find(")")-a.find("(")+1);
 					// duration
 					std::cout << " [" << m.eval(dur_action_vars[*ait][h]) << "]" << std::endl;
@@ -43,12 +60,12 @@ namespace SMTPlan {
 			// if(true) {
 
 				//events
-				std::map<int, std::vector<std::vector<z3::expr>>>::iterator eit = event_vars.begin();
-				for(; eit != event_vars.end(); eit++) {
+				for(int e=0; e<event_vars.size(); e++) {
+					if(!event_vars.has(e)) continue;
 					for(int b=0; b<opt->cascade_bound-1; b++) {
-						z3::expr v = m.eval(eit->second[h][b]);
+						z3::expr v = m.eval(event_vars[e][h][b]);
 						if(eq(v,t)) {
-							std::cout << m.eval(time_vars[h]) << ":\t" << eit->second[h][b] << " [0.0]" << std::endl;
+							std::cout << m.eval(time_vars[h]) << ":\t" << event_vars[e][h][b] << " [0.0]" << std::endl;
 						}
 					}
 				}
@@ -56,7 +73,7 @@ namespace SMTPlan {
 				// run
 				ait = action_ids.begin();
 				for(; ait != action_ids.end(); ait++) {
-					//if(run_action_vars.find(*ait)==run_action_vars.end()) continue;
+					//if(!run_action_vars.has(*ait)) continue;
 					z3::expr v = m.eval(run_action_vars[*ait][h]);
 					if(eq(v,t))	std::cout << m.eval(time_vars[h]) << ":\t" << run_action_vars[*ait][h] << "\t(running)" << std::endl;
 				}
@@ -64,24 +81,22 @@ namespace SMTPlan {
 				// end
 				ait = action_ids.begin();
 				for(; ait != action_ids.end(); ait++) {
-					if(end_action_vars.find(*ait)==end_action_vars.end()) continue;
+					if(!end_action_vars.has(*ait)) continue;
 					z3::expr v = m.eval(end_action_vars[*ait][h]);
 					if(eq(v,t))	std::cout << m.eval(time_vars[h]) << ":\t" << end_action_vars[*ait][h] << "\t(end)" << std::endl;
 				}
 
-				std::vector<std::vector<std::vector<z3::expr> > >::iterator lit = event_cascade_literal_vars.begin();
-				for(; lit != event_cascade_literal_vars.end(); lit++) {
+				for(int l=0; l<event_cascade_literal_vars.size(); l++) {
 					// for(int b=0; b<opt->cascade_bound; b++) {
 					for(int b=0; b<1; b++) {
-						z3::expr v = m.eval((*lit)[h][b]);
-						if(eq(v,t)) std::cout << m.eval(time_vars[h]) << ":\t\t" << (*lit)[h][b] << std::endl;
+						z3::expr v = m.eval(event_cascade_literal_vars[l][h][b]);
+						if(eq(v,t)) std::cout << m.eval(time_vars[h]) << ":\t\t" << event_cascade_literal_vars[l][h][b] << std::endl;
 					}
 				}
 
-				std::vector<std::vector<std::vector<z3::expr> > >::iterator fit = event_cascade_function_vars.begin();
-				for(; fit != event_cascade_function_vars.end(); fit++) {
+				for(int f=0; f<event_cascade_function_vars.size(); f++) {
 					for(int b=0; b<opt->cascade_bound; b++) {
-						std::cout << m.eval(time_vars[h]) << ":\t" << (*fit)[h][b] << " == " << m.eval((*fit)[h][b]) << std::endl;
+						std::cout << m.eval(time_vars[h]) << ":\t" << event_cascade_function_vars[f][h][b] << " == " << m.eval(event_cascade_function_vars[f][h][b]) << std::endl;
 					}
 				}
 			}
@@ -106,34 +121,44 @@ namespace SMTPlan {
 		encodeInitialState();
 		encodeGoalState(H);
 
-		// action constraints
-		enc_make_op_vars = true;
+		// operator names, printed once for all layers
 		Inst::OpStore::iterator opsItr = Inst::instantiatedOp::opsBegin();
 		Inst::OpStore::iterator opsEnd = Inst::instantiatedOp::opsEnd();
-		for (; opsItr != opsEnd; ++opsItr) {
-			Inst::instantiatedOp * const currOp = *opsItr;
-		    enc_opID = currOp->getID();
-			std::stringstream ss;
-			ss << (*currOp);
-			enc_op_string = ss.str();
-			fe = currOp->getEnv();
-			currOp->forOp()->visit(this);
+		if(enc_op_names.empty()) {
+			enc_op_names.resize(Inst::instantiatedOp::howMany());
+			for (; opsItr != opsEnd; ++opsItr) {
+				std::stringstream ss;
+				ss << (**opsItr);
+				enc_op_names[(*opsItr)->getID()] = var_factory->addPrefix(ss.str());
+			}
 		}
 
-		enc_make_op_vars = false;
+		// operators are visited once, then encoded from their templates
+		if(next_layer==0) compileOperators();
+
+		// the conditions of each operator refer to the variables of others
+		encodeOperatorVariables(H);
+
+		// action constraints
 		opsItr = Inst::instantiatedOp::opsBegin();
-		opsEnd = Inst::instantiatedOp::opsEnd();
 		for (; opsItr != opsEnd; ++opsItr) {
-			Inst::instantiatedOp * const currOp = *opsItr;
-		    enc_opID = currOp->getID();
-			std::stringstream ss;
-			ss << (*currOp);
-			enc_op_string = ss.str();
-			fe = currOp->getEnv();
-			currOp->forOp()->visit(this);
-
+		    enc_opID = (*opsItr)->getID();
+			const OperatorTemplate &tmpl = op_templates[enc_opID];
+			switch(tmpl.kind) {
+			case OP_ACTION: encodeSimpleAction(tmpl); break;
+			case OP_DURATIVE_ACTION: encodeDurativeAction(tmpl); break;
+			case OP_EVENT: encodeEvent(tmpl); break;
+			case OP_PROCESS: encodeProcess(tmpl); break;
+			default: break;
+			}
 		}
 
+		// symmetric plans
+		if(opt->symmetry) encodeSymmetryBreaking(H);
+
+		// effect lists are complete after the first layer
+		if(next_layer==0) buildSupportIndex();
+
 		// literal constraints
 		Inst::LiteralStore::iterator litItr = Inst::instantiatedOp::literalsBegin();
 		const Inst::LiteralStore::iterator litEnd = Inst::instantiatedOp::literalsEnd();
@@ -144,6 +169,9 @@ namespace SMTPlan {
 			encodeLiteralVariableSupport(H);
 		}
 
+		// mutex groups
+		if(opt->mutex_groups) encodeMutexGroups(H);
+
 		// function constraints
 		Inst::PNEStore::iterator pneItr = Inst::instantiatedOp::pnesBegin();
 		const Inst::PNEStore::iterator pneEnd = Inst::instantiatedOp::pnesEnd();
@@ -164,18 +192,25 @@ namespace SMTPlan {
 
 	void EncoderHappening::encodeHeader(int H) {
 
+		// make room for the new layers
+		event_cascade_function_vars.addLayers(H);
+		event_cascade_literal_vars.addLayers(H);
+		event_vars.addLayers(H);
+		sta_action_vars.addLayers(H);
+		end_action_vars.addLayers(H);
+		dur_action_vars.addLayers(H);
+		run_action_vars.addLayers(H);
+		til_vars.addLayers(H);
+
 		// timings
 		for(int h=next_layer; h<H; h++) {
-			std::stringstream ss1;
-			ss1 << "t" << h;
-			time_vars.push_back(z3_context->real_const(ss1.str().c_str()));
-			std::stringstream ss2;
-			ss2 << "d" << h;
-			duration_vars.push_back(z3_context->real_const(ss2.str().c_str()));
+			time_vars.push_back(var_factory->mk_real(enc_time_name, h, ""));
+			duration_vars.push_back(var_factory->mk_real(enc_duration_name, h, ""));
 
 		}
 
 		// literals
+		if(opt->finite_domain && next_layer == 0) findStateVariables();
 		Inst::LiteralStore::iterator litItr = Inst::instantiatedOp::literalsBegin();
 		const Inst::LiteralStore::iterator litEnd = Inst::instantiatedOp::literalsEnd();
 		for (; litItr != litEnd; ++litItr) {
@@ -191,17 +226,24 @@ namespace SMTPlan {
 				simpleTILAddEffects[currLit->getID()];
 				simpleTILDelEffects[currLit->getID()];
 
-				event_cascade_literal_vars[currLit->getID()];
+
+				std::stringstream ss;
+				ss << (*currLit);
+				enc_lit_names[currLit->getID()] = var_factory->addPrefix(ss.str());
 			}
 
+			// literals of state variables are set below
+			if(opt->finite_domain && enc_domain_literal[currLit->getID()]) continue;
+
+			// literals that can never be true are constant, others are false before their first happening
+			bool unreachable = problem_info->unreachableLiterals.count(currLit->getID()) > 0;
 			for(int h=next_layer; h<H; h++) {
-				std::vector<z3::expr> literalVars;
 				for(int b=0; b<opt->cascade_bound; b++) {
-					std::stringstream ss;
-					ss << (*currLit) << h << "_" << b;
-					literalVars.push_back(z3_context->bool_const(ss.str().c_str()));
+					event_cascade_literal_vars.set(currLit->getID(), h, b, unreachable ? z3_context->bool_val(false)
+							: var_factory->mk_cascade_bool(enc_lit_names[currLit->getID()], h, b));
+					if(!unreachable && h < problem_info->firstLiteralHappening(currLit->getID()))
+						z3_solver->add(!event_cascade_literal_vars[currLit->getID()][h][b]);
 				}
-				event_cascade_literal_vars[currLit->getID()].push_back(literalVars);
 			}
 		}
 
@@ -212,17 +254,224 @@ namespace SMTPlan {
 			Inst::PNE * const currPNE = *pneItr;
 
 			if(next_layer == 0) {
-				event_cascade_literal_vars[currPNE->getID()];
+
+				std::stringstream ss;
+				ss << (*currPNE);
+				enc_pne_names[currPNE->getID()] = var_factory->addPrefix(ss.str());
 			}
 
 			for(int h=next_layer; h<H; h++) {
-				std::vector<z3::expr> functionVars;
 				for(int b=0; b<opt->cascade_bound; b++) {
+					event_cascade_function_vars.set(currPNE->getID(), h, b, var_factory->mk_cascade_real(enc_pne_names[currPNE->getID()], h, b));
+				}
+			}
+		}
+
+		if(opt->finite_domain) encodeStateVariables(H);
+	}
+
+	/*--------------*/
+	/* mutex groups */
+	/*--------------*/
+
+	/**
+	 * At most one literal of each mutex group holds at each happening
+	 * and cascade level. Small groups are encoded pairwise. Larger groups
+	 * use a sequential counter, where the ith auxiliary variable holds
+	 * if any of the first i+1 literals does.
+	 */
+	void EncoderHappening::encodeMutexGroups(int H) {
+
+		std::vector<MutexGroup> &groups = problem_info->mutexGroups;
+		if(enc_mutex_names.empty()) {
+			enc_mutex_names.resize(groups.size());
+			for(unsigned int g=0; g<groups.size(); g++) {
+				for(unsigned int i=0; i+1<groups[g].literals.size(); i++) {
 					std::stringstream ss;
-					ss << (*currPNE) << h << "_" << b;
-					functionVars.push_back(z3_context->real_const(ss.str().c_str()));
+					ss << "mutex" << g << "_" << i << "_";
+					enc_mutex_names[g].push_back(var_factory->addPrefix(ss.str()));
+				}
+			}
+		}
+
+		for(int h=next_layer; h<H; h++) {
+			for(int b=0; b<opt->cascade_bound; b++) {
+				for(unsigned int g=0; g<groups.size(); g++) {
+
+					// state variables hold one value by construction
+					if(opt->finite_domain && enc_domain_groups[g]) continue;
+
+					const std::vector<int> &lits = groups[g].literals;
+					z3::expr_vector vars(*z3_context);
+					for(unsigned int i=0; i<lits.size(); i++)
+						vars.push_back(event_cascade_literal_vars[lits[i]][h][b]);
+
+					if(groups[g].exactlyOne)
+						z3_solver->add(mk_or(vars));
+
+					if(vars.size() <= 4) {
+						for(unsigned int i=0; i<vars.size(); i++)
+							for(unsigned int j=i+1; j<vars.size(); j++)
+								z3_solver->add(!vars[i] || !vars[j]);
+						continue;
+					}
+
+					z3::expr prev = z3_context->bool_val(false);
+					for(unsigned int i=0; i<vars.size(); i++) {
+						z3_solver->add(!vars[i] || !prev);
+						if(i+1 == vars.size()) break;
+						z3::expr aux = var_factory->mk_cascade_bool(enc_mutex_names[g][i], h, b);
+						z3_solver->add(!vars[i] || aux);
+						z3_solver->add(!prev || aux);
+						prev = aux;
+					}
+				}
+			}
+		}
+	}
+
+	/*-----------------*/
+	/* state variables */
+	/*-----------------*/
+
+	/**
+	 * Each exactly-one mutex group becomes a state variable, unless it
+	 * shares a literal with a group that already has. Only exactly-one
+	 * groups are used, so no "none" value is needed; MutexGroups makes
+	 * none for domains with events or for spaces with running durative
+	 * actions. Literals that can never be true are left out, as the
+	 * group still holds exactly one of the others.
+	 */
+	void EncoderHappening::findStateVariables() {
+
+		std::vector<MutexGroup> &groups = problem_info->mutexGroups;
+		enc_domain_groups = std::vector<bool>(groups.size(), false);
+		enc_domain_literal = std::vector<bool>(Inst::instantiatedOp::howManyLiterals(), false);
+
+		for(unsigned int g=0; g<groups.size(); g++) {
+			if(!groups[g].exactlyOne) continue;
+
+			std::vector<int> lits;
+			bool shared = false;
+			for(unsigned int i=0; i<groups[g].literals.size(); i++) {
+				int id = groups[g].literals[i];
+				if(enc_domain_literal[id]) shared = true;
+				if(!problem_info->unreachableLiterals.count(id)) lits.push_back(id);
+			}
+			if(shared || lits.size() < 2) continue;
+
+			int bits = 0;
+			while((1u << bits) < lits.size()) bits++;
+
+			std::vector<int> names;
+			for(int j=0; j<bits; j++) {
+				std::stringstream ss;
+				ss << "domain" << enc_domain_literals.size() << "_" << j << "_";
+				names.push_back(var_factory->addPrefix(ss.str()));
+			}
+
+			enc_domain_groups[g] = true;
+			for(unsigned int i=0; i<lits.size(); i++) enc_domain_literal[lits[i]] = true;
+			enc_domain_literals.push_back(lits);
+			enc_domain_names.push_back(names);
+		}
+
+		// unreachable literals of the groups are constant
+		for(unsigned int g=0; g<groups.size(); g++) {
+			if(!enc_domain_groups[g]) continue;
+			for(unsigned int i=0; i<groups[g].literals.size(); i++)
+				enc_domain_literal[groups[g].literals[i]] = true;
+		}
+	}
+
+	/**
+	 * A literal of a state variable is the conjunction of the bits of
+	 * its code, and codes past the last literal are excluded.
+	 */
+	void EncoderHappening::encodeStateVariables(int H) {
+
+		std::vector<MutexGroup> &groups = problem_info->mutexGroups;
+		for(unsigned int g=0; g<groups.size(); g++) {
+			if(!enc_domain_groups[g]) continue;
+			for(unsigned int i=0; i<groups[g].literals.size(); i++) {
+				int id = groups[g].literals[i];
+				if(!problem_info->unreachableLiterals.count(id)) continue;
+				for(int h=next_layer; h<H; h++)
+					for(int b=0; b<opt->cascade_bound; b++)
+						event_cascade_literal_vars.set(id, h, b, z3_context->bool_val(false));
+			}
+		}
+
+		for(unsigned int d=0; d<enc_domain_literals.size(); d++) {
+
+			const std::vector<int> &lits = enc_domain_literals[d];
+			const std::vector<int> &names = enc_domain_names[d];
+
+			for(int h=next_layer; h<H; h++) {
+				for(int b=0; b<opt->cascade_bound; b++) {
+
+					std::vector<z3::expr> bits;
+					for(unsigned int j=0; j<names.size(); j++)
+						bits.push_back(var_factory->mk_cascade_bool(names[j], h, b));
+
+					for(unsigned int code=0; code < (1u << names.size()); code++) {
+						z3::expr_vector match(*z3_context);
+						for(unsigned int j=0; j<bits.size(); j++)
+							match.push_back(((code >> j) & 1) ? bits[j] : !bits[j]);
+						if(code >= lits.size()) {
+							z3_solver->add(!mk_and(match));
+							continue;
+						}
+						event_cascade_literal_vars.set(lits[code], h, b, mk_and(match));
+						if(h < problem_info->firstLiteralHappening(lits[code]))
+							z3_solver->add(!event_cascade_literal_vars[lits[code]][h][b]);
+					}
+				}
+			}
+		}
+	}
+
+	/*-------------------*/
+	/* symmetry breaking */
+	/*-------------------*/
+
+	/**
+	 * For each operator symmetry s, the actions started at each happening,
+	 * in order of happening and then operator ID, must be lexicographically
+	 * no greater than their image under s. Swapping the objects of s maps
+	 * any plan onto another, so one of each pair of plans remains. As s
+	 * swaps operators in pairs, only operators before their image are
+	 * compared. Each happening extends the comparison of the last.
+	 */
+	void EncoderHappening::encodeSymmetryBreaking(int H) {
+
+		std::vector<std::vector<int> > &symmetries = problem_info->operatorSymmetries;
+		if(enc_symmetry_names.empty()) {
+			for(unsigned int s=0; s<symmetries.size(); s++) {
+				std::stringstream ss;
+				ss << "symmetry" << s << "_";
+				enc_symmetry_names.push_back(var_factory->addPrefix(ss.str()));
+				enc_symmetry_equal.push_back(z3_context->bool_val(true));
+			}
+		}
+
+		for(unsigned int s=0; s<symmetries.size(); s++) {
+			const std::vector<int> &image = symmetries[s];
+			for(int h=next_layer; h<H; h++) {
+				int position = 0;
+				for(unsigned int op=0; op<image.size(); op++) {
+					if((int)op >= image[op]) continue;
+					if(!sta_action_vars.has(op) || !sta_action_vars.has(image[op])) continue;
+
+					z3::expr x = sta_action_vars[op][h];
+					z3::expr y = sta_action_vars[image[op]][h];
+					z3::expr equal = enc_symmetry_equal[s];
+					z3_solver->add(implies(equal, !x || y));
+
+					z3::expr next = var_factory->mk_cascade_bool(enc_symmetry_names[s], h, position++);
+					z3_solver->add(implies(equal && (x == y), next));
+					enc_symmetry_equal[s] = next;
 				}
-				event_cascade_function_vars[currPNE->getID()].push_back(functionVars);
 			}
 		}
 	}
@@ -343,16 +592,18 @@ namespace SMTPlan {
 
 	void EncoderHappening::visit_timed_initial_literal(VAL::timed_initial_literal * til) {
 
-		til_vars[enc_tilID];
+		if(enc_til_names.find(enc_tilID) == enc_til_names.end()) {
+			std::stringstream ss;
+			ss << "til_" << enc_tilID << "_";
+			enc_til_names[enc_tilID] = var_factory->addPrefix(ss.str());
+		}
 
 		for(int h=next_layer; h<upper_bound; h++) {
 
 			// MAKE VARS
-			std::stringstream ss;
-			ss << "til_" << enc_tilID << "_" << h;
-			til_vars[enc_tilID].push_back(z3_context->bool_const(ss.str().c_str()));
-			ss.str("");
+			til_vars.set(enc_tilID, h, var_factory->mk_bool(enc_til_names[enc_tilID], h, ""));
 
+			std::stringstream ss;
 			ss << til->time_stamp;
 			z3::expr time_value = z3_context->real_val(ss.str().c_str());
 
@@ -376,319 +627,351 @@ namespace SMTPlan {
 		}
 	};
 
-	/*---------*/
-	/* actions */
-	/*---------*/
+	/*-----------*/
+	/* operators */
+	/*-----------*/
 
 	/**
-	 * Constraints H9-H10, H14-15, P7-P8 (A Compilation of the Full PDDL+ Language into SMT)
-	 * encodes durative action constraints
+	 * Visits each operator once, recording its conditions, effects and
+	 * duration constraints in its template. Nothing is encoded while
+	 * compiling; every layer, including the first, is encoded from the
+	 * templates.
 	 */
+	void EncoderHappening::compileOperators() {
+
+		Inst::OpStore::iterator opsItr = Inst::instantiatedOp::opsBegin();
+		const Inst::OpStore::iterator opsEnd = Inst::instantiatedOp::opsEnd();
+		for (; opsItr != opsEnd; ++opsItr) {
+			Inst::instantiatedOp * const currOp = *opsItr;
+		    enc_opID = currOp->getID();
+			fe = currOp->getEnv();
+			enc_template = &op_templates[enc_opID];
+			currOp->forOp()->visit(this);
+		}
+		enc_template = NULL;
+		enc_state = ENC_NONE;
+	}
+
 	void EncoderHappening::visit_durative_action(VAL::durative_action * da) {
 
-		if(enc_make_op_vars)
-		{
-			sta_action_vars[enc_opID];
-			run_action_vars[enc_opID];
-			end_action_vars[enc_opID];
-			dur_action_vars[enc_opID];
+		enc_template->kind = OP_DURATIVE_ACTION;
 
-			// remember which operators are actions and not processes
-			if(next_layer==0) {
-				action_ids.push_back(enc_opID);
-			}
+		enc_state = ENC_ACTION_DURATION;
+		da->dur_constraint->visit(this);
 
-			for(int h=next_layer; h<upper_bound; h++) {
+		enc_state = ENC_ACTION_EFFECT;
+		da->effects->visit(this);
 
-				// MAKE VARS
-				std::stringstream ss;
-				ss << enc_op_string << h << "_sta";
-				sta_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_end";
-				end_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_run";
-				run_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_dur";
-				dur_action_vars[enc_opID].push_back(z3_context->real_const(ss.str().c_str()));
-		
-				// running action/process iff (remaining duration > 0)
-				z3_solver->add(run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] > 0));
-				z3_solver->add(!run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] == 0));
-
-				// remaining duration (i) = remaining duration (i-1) - duration (i)
-				if(h>0) {
-					z3_solver->add(implies(run_action_vars[enc_opID][h-1],
-							dur_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h-1] - duration_vars[h-1])));
-				}
+		enc_state = ENC_ACTION_CONDITION;
+		if (da->precondition) da->precondition->visit(this);
+	}
 
-				// remaining duration = action duration
-				z3_solver->add(implies(sta_action_vars[enc_opID][h], run_action_vars[enc_opID][h]));
-				z3_solver->add(implies(end_action_vars[enc_opID][h], dur_action_vars[enc_opID][h] == 0));
+	void EncoderHappening::visit_action(VAL::action * o) {
 
-				// start->run->end
-				if(h>0) {
-					z3_solver->add(implies(end_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1]));
-					z3_solver->add(implies(sta_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1]));
-					z3_solver->add(implies(run_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1] || sta_action_vars[enc_opID][h]));
-					z3_solver->add(implies(!run_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1] || end_action_vars[enc_opID][h]));
-				} else {
-					z3_solver->add(!end_action_vars[enc_opID][h]);
-					z3_solver->add(implies(run_action_vars[enc_opID][h], sta_action_vars[enc_opID][h]));
-					z3_solver->add(implies(!run_action_vars[enc_opID][h], !sta_action_vars[enc_opID][h]));
-				}
-			}
+		enc_template->kind = OP_ACTION;
 
-		}
-		else
-		{
-			enc_expression_b = opt->cascade_bound - 2;
-			for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
+		enc_eff_time = VAL::E_AT_START;
+		enc_state = ENC_SIMPLE_ACTION_EFFECT;
+		o->effects->visit(this);
 
-				// duration
-				enc_state = ENC_ACTION_DURATION;
-				da->dur_constraint->visit(this);
+		// a simple action has only a start
+		enc_cond_time = VAL::E_AT_START;
+		enc_state = ENC_SIMPLE_ACTION_CONDITION;
+		if (o->precondition) o->precondition->visit(this);
+	}
 
-				// effects (sets up add/delete effect lists)
-				enc_state = ENC_ACTION_EFFECT;
-				da->effects->visit(this);
+	void EncoderHappening::visit_event(VAL::event * e) {
 
-				// conditions (sets up mutex lists)
-				enc_state = ENC_ACTION_CONDITION;
-			   	if (da->precondition) da->precondition->visit(this);
+		enc_template->kind = OP_EVENT;
 
-				enc_state = ENC_NONE;
-			}
+		enc_eff_time = VAL::E_AT_START;
+		enc_state = ENC_EVENT_EFFECT;
+		e->effects->visit(this);
 
-			goal_expression.push_back(!run_action_vars[enc_opID][upper_bound-1]);
-		}
+		enc_state = ENC_EVENT_CONDITION;
+		if (e->precondition) e->precondition->visit(this);
 	}
 
-	void EncoderHappening::visit_action(VAL::action * o) {
+	void EncoderHappening::visit_process(VAL::process * p) {
 
-		if(enc_make_op_vars)
-		{
-			sta_action_vars[enc_opID];
-			dur_action_vars[enc_opID];
+		enc_template->kind = OP_PROCESS;
 
-			// remember which operators are actions and not processes
-			if(next_layer==0) {
-				action_ids.push_back(enc_opID);
-			}
+		enc_state = ENC_ACTION_EFFECT;
+		p->effects->visit(this);
 
-			for(int h=next_layer; h<upper_bound; h++) {
-			
-				// MAKE VARS
-				std::stringstream ss;
-				ss << enc_op_string << h << "_sta";
-				sta_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_dur";
-				dur_action_vars[enc_opID].push_back(z3_context->real_const(ss.str().c_str()));
-
-				// (duration == 0)
-				z3_solver->add(dur_action_vars[enc_opID][h] == 0);
-			}
-		}
-		else
-		{
+		enc_state = ENC_PROCESS_CONDITION;
+		if (p->precondition) p->precondition->visit(this);
+	}
 
-			enc_expression_b = opt->cascade_bound - 2;
-			for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
+	/**
+	 * Makes the variables of every operator for the new layers, with the
+	 * constraints between them. This is a loop over the operators; their
+	 * kinds were recorded when they were compiled.
+	 */
+	void EncoderHappening::encodeOperatorVariables(int H) {
 
-				enc_eff_time = VAL::E_AT_START;
+		Inst::OpStore::iterator opsItr = Inst::instantiatedOp::opsBegin();
+		const Inst::OpStore::iterator opsEnd = Inst::instantiatedOp::opsEnd();
+		for (; opsItr != opsEnd; ++opsItr) {
+		    enc_opID = (*opsItr)->getID();
+			enc_op_name = enc_op_names[enc_opID];
 
-				// effects (sets up add/delete effect lists)
-				enc_state = ENC_SIMPLE_ACTION_EFFECT;
-				o->effects->visit(this);
+			switch(op_templates[enc_opID].kind) {
 
-				// conditions (sets up mutex lists)
-				enc_state = ENC_SIMPLE_ACTION_CONDITION;
-			   	if (o->precondition) o->precondition->visit(this);
+			case OP_DURATIVE_ACTION:
 
-				enc_state = ENC_NONE;
-			}
-		}
-	}
+				// remember which operators are actions and not processes
+				if(next_layer==0) {
+					action_ids.push_back(enc_opID);
+				}
 
-	/*--------*/
-	/* events */
-	/*--------*/
+				for(int h=next_layer; h<H; h++) {
 
-	void EncoderHappening::visit_event(VAL::event * e){
+					// MAKE VARS
+					sta_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_sta"));
+					end_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_end"));
+					run_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_run"));
+					dur_action_vars.set(enc_opID, h, var_factory->mk_real(enc_op_name, h, "_dur"));
 
-		if(enc_make_op_vars)
-		{
-			event_vars[enc_opID];
+					// cannot start before it is reachable
+					if(h < problem_info->firstOperatorHappening(enc_opID))
+						z3_solver->add(!sta_action_vars[enc_opID][h]);
 
-			for(int h=next_layer; h<upper_bound; h++) {
-				// MAKE VARS
-				std::vector<z3::expr> eventVars;
-				for(enc_expression_b=0; enc_expression_b<opt->cascade_bound-1; enc_expression_b++) {
-					std::stringstream ss;
-					ss << enc_op_string << h << "_" << enc_expression_b;
-					eventVars.push_back(z3_context->bool_const(ss.str().c_str()));
+					// running action/process iff (remaining duration > 0)
+					z3_solver->add(run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] > 0));
+					z3_solver->add(!run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] == 0));
+
+					// remaining duration (i) = remaining duration (i-1) - duration (i)
+					if(h>0) {
+						z3_solver->add(implies(run_action_vars[enc_opID][h-1],
+								dur_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h-1] - duration_vars[h-1])));
+					}
+
+					// remaining duration = action duration
+					z3_solver->add(implies(sta_action_vars[enc_opID][h], run_action_vars[enc_opID][h]));
+					z3_solver->add(implies(end_action_vars[enc_opID][h], dur_action_vars[enc_opID][h] == 0));
+
+					// start->run->end
+					if(h>0) {
+						z3_solver->add(implies(end_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1]));
+						z3_solver->add(implies(sta_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1]));
+						z3_solver->add(implies(run_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1] || sta_action_vars[enc_opID][h]));
+						z3_solver->add(implies(!run_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1] || end_action_vars[enc_opID][h]));
+					} else {
+						z3_solver->add(!end_action_vars[enc_opID][h]);
+						z3_solver->add(implies(run_action_vars[enc_opID][h], sta_action_vars[enc_opID][h]));
+						z3_solver->add(implies(!run_action_vars[enc_opID][h], !sta_action_vars[enc_opID][h]));
+					}
 				}
-				event_vars[enc_opID].push_back(eventVars);
-			}
-		}
-		else
-		{
-			for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
+				break;
 
-				enc_eff_time = VAL::E_AT_START;
+			case OP_ACTION:
 
-				// conditions (sets up mutex lists)
-				for(enc_expression_b=0; enc_expression_b<opt->cascade_bound-1; enc_expression_b++) {
+				// remember which operators are actions and not processes
+				if(next_layer==0) {
+					action_ids.push_back(enc_opID);
+				}
 
-					// effects (sets up add/delete effect lists)
-					enc_state = ENC_EVENT_EFFECT;
-					e->effects->visit(this);
+				for(int h=next_layer; h<H; h++) {
 
-					enc_state = ENC_EVENT_CONDITION;
-					enc_event_condition_stack = new z3::expr_vector(*z3_context);
-					enc_musts_expression_stack.clear();
-					enc_musts_discrete_stack.clear();
+					// MAKE VARS
+					sta_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_sta"));
+					dur_action_vars.set(enc_opID, h, var_factory->mk_real(enc_op_name, h, "_dur"));
 
-					// make event trigger and save parts of MUST condition
-				   	if (e->precondition) e->precondition->visit(this);
-					z3_solver->add(event_vars[enc_opID][enc_expression_h][enc_expression_b] == mk_and(*enc_event_condition_stack));
-
-					if(enc_expression_b == 0 && enc_expression_h > 0) {
-
-						// make rest of must condition
-						std::vector<z3::expr> current;
-						current.insert(current.begin(), enc_musts_expression_stack.begin(), enc_musts_expression_stack.end());
-						enc_expression_h--;
-						enc_expression_b = opt->cascade_bound - 1;
-						enc_musts_expression_stack.clear();
-						enc_musts_discrete_stack.clear();
-					   	if (e->precondition) e->precondition->visit(this);
-						enc_expression_h++;
-						enc_expression_b = 0;
-
-						// create boundary equations
-						z3::expr_vector mustConstraints(*z3_context);
-						while(enc_musts_expression_stack.size() > 0) {
-							mustConstraints.push_back(current.back() * enc_musts_expression_stack.back() >= 0);
-							enc_musts_expression_stack.pop_back();
-							current.pop_back();
-						}
+					// cannot start before it is reachable
+					if(h < problem_info->firstOperatorHappening(enc_opID))
+						z3_solver->add(!sta_action_vars[enc_opID][h]);
+
+					// (duration == 0)
+					z3_solver->add(dur_action_vars[enc_opID][h] == 0);
+				}
+				break;
 
-						/*/ add negative discrete conditions
-						while(enc_musts_discrete_stack.size() > 0) {
-							mustConstraints.push_back(enc_musts_discrete_stack.back());
-							enc_musts_discrete_stack.pop_back();
-						}*/
+			case OP_EVENT:
 
-						// declare must condition
-						z3_solver->add(mk_and(mustConstraints));
+				for(int h=next_layer; h<H; h++) {
+					// MAKE VARS
+					for(int b=0; b<opt->cascade_bound-1; b++) {
+						event_vars.set(enc_opID, h, b, var_factory->mk_cascade_bool(enc_op_name, h, b));
+						if(h < problem_info->firstOperatorHappening(enc_opID))
+							z3_solver->add(!event_vars[enc_opID][h][b]);
 					}
-					delete enc_event_condition_stack;				
 				}
+				break;
 
-				enc_state = ENC_NONE;
-			}
-		}
-	}
+			case OP_PROCESS:
 
-	/*-----------*/
-	/* processes */
-	/*-----------*/
+				for(int h=next_layer; h<H; h++) {
 
-    void EncoderHappening::visit_process(VAL::process * p){
+					// MAKE VARS
+					sta_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_sta"));
+					end_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_end"));
+					run_action_vars.set(enc_opID, h, var_factory->mk_bool(enc_op_name, h, "_run"));
+					dur_action_vars.set(enc_opID, h, var_factory->mk_real(enc_op_name, h, "_dur"));
 
-		if(enc_make_op_vars)
-		{
-			sta_action_vars[enc_opID];
-			run_action_vars[enc_opID];
-			end_action_vars[enc_opID];
-			dur_action_vars[enc_opID];
+					// cannot start before it is reachable
+					if(h < problem_info->firstOperatorHappening(enc_opID))
+						z3_solver->add(!sta_action_vars[enc_opID][h]);
 
-			for(int h=next_layer; h<upper_bound; h++) {
-			
-				// MAKE VARS
-				std::stringstream ss;
-				ss << enc_op_string << h << "_sta";
-				sta_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_end";
-				end_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_run";
-				run_action_vars[enc_opID].push_back(z3_context->bool_const(ss.str().c_str()));
-				ss.str("");
-				ss << enc_op_string << h << "_dur";
-				dur_action_vars[enc_opID].push_back(z3_context->real_const(ss.str().c_str()));
-		
-				// running action/process iff (remaining duration > 0)
-				z3_solver->add(run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] > 0));
-				z3_solver->add(!run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] == 0));
-
-				// remaining duration (i) = remaining duration (i-1) - duration (i)
-				if(h>0) {
-					z3_solver->add(implies(run_action_vars[enc_opID][h-1],
-							dur_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h-1] - duration_vars[h-1])));
-				}
+					// running action/process iff (remaining duration > 0)
+					z3_solver->add(run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] > 0));
+					z3_solver->add(!run_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h] == 0));
 
-				// remaining duration = action duration
-				z3_solver->add(implies(sta_action_vars[enc_opID][h], run_action_vars[enc_opID][h]));
-				z3_solver->add(implies(end_action_vars[enc_opID][h], dur_action_vars[enc_opID][h] == 0));
+					// remaining duration (i) = remaining duration (i-1) - duration (i)
+					if(h>0) {
+						z3_solver->add(implies(run_action_vars[enc_opID][h-1],
+								dur_action_vars[enc_opID][h] == (dur_action_vars[enc_opID][h-1] - duration_vars[h-1])));
+					}
 
-				// start->run->end
-				if(h>0) {
-					z3_solver->add(implies(end_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1]));
+					// remaining duration = action duration
 					z3_solver->add(implies(sta_action_vars[enc_opID][h], run_action_vars[enc_opID][h]));
-					z3_solver->add(implies(sta_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1]));
-					z3_solver->add(implies(run_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1] || sta_action_vars[enc_opID][h]));
-					z3_solver->add(implies(!run_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1] || end_action_vars[enc_opID][h]));
-				} else {
-					z3_solver->add(!end_action_vars[enc_opID][h]);
-					z3_solver->add(implies(run_action_vars[enc_opID][h], sta_action_vars[enc_opID][h]));
-					z3_solver->add(implies(sta_action_vars[enc_opID][h], run_action_vars[enc_opID][h]));
-					z3_solver->add(implies(!run_action_vars[enc_opID][h], !sta_action_vars[enc_opID][h]));
+					z3_solver->add(implies(end_action_vars[enc_opID][h], dur_action_vars[enc_opID][h] == 0));
+
+					// start->run->end
+					if(h>0) {
+						z3_solver->add(implies(end_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1]));
+						z3_solver->add(implies(sta_action_vars[enc_opID][h], run_action_vars[enc_opID][h]));
+						z3_solver->add(implies(sta_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1]));
+						z3_solver->add(implies(run_action_vars[enc_opID][h], run_action_vars[enc_opID][h-1] || sta_action_vars[enc_opID][h]));
+						z3_solver->add(implies(!run_action_vars[enc_opID][h], !run_action_vars[enc_opID][h-1] || end_action_vars[enc_opID][h]));
+					} else {
+						z3_solver->add(!end_action_vars[enc_opID][h]);
+						z3_solver->add(implies(run_action_vars[enc_opID][h], sta_action_vars[enc_opID][h]));
+						z3_solver->add(implies(sta_action_vars[enc_opID][h], run_action_vars[enc_opID][h]));
+						z3_solver->add(implies(!run_action_vars[enc_opID][h], !sta_action_vars[enc_opID][h]));
+					}
 				}
+				break;
+
+			default:
+				break;
 			}
 		}
-		else
-		{
-			enc_expression_b = opt->cascade_bound - 1;
-			for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
+	}
+
+	/**
+	 * Encodes the effects of the template at happening enc_expression_h
+	 * and cascade level enc_expression_b, in the current state.
+	 */
+	void EncoderHappening::encodeTemplateEffects(const OperatorTemplate &tmpl) {
+
+		std::vector<LiteralTemplate>::const_iterator lit = tmpl.effects.begin();
+		for(; lit != tmpl.effects.end(); ++lit) {
+			enc_eff_neg = lit->negative;
+			enc_eff_time = lit->time;
+			encodeLiteralEffect(lit->literal);
+		}
+		enc_eff_neg = false;
+
+		std::vector<AssignmentTemplate>::const_iterator ait = tmpl.assignments.begin();
+		for(; ait != tmpl.assignments.end(); ++ait) {
+			enc_eff_time = ait->time;
+			encodeAssignment(ait->function, ait->op, mk_template_expr(ait->value));
+		}
+	}
+
+	/* as encodeTemplateEffects, for the conditions */
+	void EncoderHappening::encodeTemplateConditions(const OperatorTemplate &tmpl) {
+
+		std::vector<LiteralTemplate>::const_iterator lit = tmpl.conditions.begin();
+		for(; lit != tmpl.conditions.end(); ++lit) {
+			enc_cond_neg = lit->negative;
+			enc_cond_time = lit->time;
+			encodeLiteralCondition(lit->literal);
+		}
+		enc_cond_neg = false;
+
+		std::vector<ComparisonTemplate>::const_iterator cit = tmpl.comparisons.begin();
+		for(; cit != tmpl.comparisons.end(); ++cit)
+			encodeComparison(*cit);
+	}
+
+	/*---------*/
+	/* actions */
+	/*---------*/
+
+	void EncoderHappening::encodeSimpleAction(const OperatorTemplate &tmpl) {
+
+		enc_expression_b = opt->cascade_bound - 2;
+		for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
+
+			// effects (sets up add/delete effect lists)
+			enc_state = ENC_SIMPLE_ACTION_EFFECT;
+			encodeTemplateEffects(tmpl);
+
+			// conditions (sets up mutex lists)
+			enc_state = ENC_SIMPLE_ACTION_CONDITION;
+			encodeTemplateConditions(tmpl);
+
+			enc_state = ENC_NONE;
+		}
+	}
+
+	/**
+	 * Constraints H9-H10, H14-15, P7-P8 (A Compilation of the Full PDDL+ Language into SMT)
+	 * encodes durative action constraints
+	 */
+	void EncoderHappening::encodeDurativeAction(const OperatorTemplate &tmpl) {
+
+		enc_expression_b = opt->cascade_bound - 2;
+		for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
+
+			// duration
+			enc_state = ENC_ACTION_DURATION;
+			std::vector<ComparisonTemplate>::const_iterator cit = tmpl.duration.begin();
+			for(; cit != tmpl.duration.end(); ++cit)
+				encodeComparison(*cit);
+
+			// effects (sets up add/delete effect lists)
+			enc_state = ENC_ACTION_EFFECT;
+			encodeTemplateEffects(tmpl);
+
+			// conditions (sets up mutex lists)
+			enc_state = ENC_ACTION_CONDITION;
+			encodeTemplateConditions(tmpl);
+
+			enc_state = ENC_NONE;
+		}
+
+		goal_expression.push_back(!run_action_vars[enc_opID][upper_bound-1]);
+	}
+
+	/*--------*/
+	/* events */
+	/*--------*/
+
+	void EncoderHappening::encodeEvent(const OperatorTemplate &tmpl) {
+
+		for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
+
+			// conditions (sets up mutex lists)
+			for(enc_expression_b=0; enc_expression_b<opt->cascade_bound-1; enc_expression_b++) {
 
 				// effects (sets up add/delete effect lists)
-				enc_state = ENC_ACTION_EFFECT;
-				p->effects->visit(this);
+				enc_state = ENC_EVENT_EFFECT;
+				encodeTemplateEffects(tmpl);
 
-				// conditions (sets up mutex lists)
-				enc_state = ENC_PROCESS_CONDITION;
+				enc_state = ENC_EVENT_CONDITION;
 				enc_event_condition_stack = new z3::expr_vector(*z3_context);
 				enc_musts_expression_stack.clear();
 				enc_musts_discrete_stack.clear();
 
-				// make process trigger
-			   	if (p->precondition) p->precondition->visit(this);
+				// make event trigger and save parts of MUST condition
+				encodeTemplateConditions(tmpl);
+				z3_solver->add(event_vars[enc_opID][enc_expression_h][enc_expression_b] == mk_and(*enc_event_condition_stack));
 
-				z3_solver->add( run_action_vars[enc_opID][enc_expression_h] == mk_and(*enc_event_condition_stack) );
-
-				if(enc_expression_h > 0) {
-
-					// fetch half of the must conditions
-					enc_musts_expression_stack.clear();
-					enc_musts_discrete_stack.clear();
-					enc_expression_b = 0;
-				   	if (p->precondition) p->precondition->visit(this);
-					enc_expression_b = opt->cascade_bound - 1;
+				if(enc_expression_b == 0 && enc_expression_h > 0) {
 
 					// make rest of must condition
 					std::vector<z3::expr> current;
 					current.insert(current.begin(), enc_musts_expression_stack.begin(), enc_musts_expression_stack.end());
 					enc_expression_h--;
+					enc_expression_b = opt->cascade_bound - 1;
 					enc_musts_expression_stack.clear();
 					enc_musts_discrete_stack.clear();
-				   	if (p->precondition) p->precondition->visit(this);
+					encodeTemplateConditions(tmpl);
 					enc_expression_h++;
+					enc_expression_b = 0;
 
 					// create boundary equations
 					z3::expr_vector mustConstraints(*z3_context);
@@ -697,117 +980,179 @@ namespace SMTPlan {
 						enc_musts_expression_stack.pop_back();
 						current.pop_back();
 					}
-					while(mustConstraints.size() > 0) {
-						z3_solver->add(implies(run_action_vars[enc_opID][enc_expression_h-1], mustConstraints.back()));
-						mustConstraints.pop_back();
-					}
+
+					/*/ add negative discrete conditions
+					while(enc_musts_discrete_stack.size() > 0) {
+						mustConstraints.push_back(enc_musts_discrete_stack.back());
+						enc_musts_discrete_stack.pop_back();
+					}*/
+
+					// declare must condition
+					z3_solver->add(mk_and(mustConstraints));
 				}
-				delete enc_event_condition_stack;				
-				enc_state = ENC_NONE;
+				delete enc_event_condition_stack;
 			}
+
+			enc_state = ENC_NONE;
 		}
 	}
 
-	/*----------*/
-	/* literals */
-	/*----------*/
+	/*-----------*/
+	/* processes */
+	/*-----------*/
 
-	/**
-	 * Constraints H1--H4, P5-P6 (A Compilation of the Full PDDL+ Language into SMT)
-	 * Encodes variable support in the form of explanatory frame axioms.
-	 */
-	void EncoderHappening::encodeLiteralVariableSupport(int H) {
+	void EncoderHappening::encodeProcess(const OperatorTemplate &tmpl) {
 
-		for(int h=next_layer;h<H;h++) {
+		enc_expression_b = opt->cascade_bound - 1;
+		for(enc_expression_h=next_layer; enc_expression_h<upper_bound; enc_expression_h++) {
 
-			for(int b=1;b<opt->cascade_bound;b++) {
+			// effects (sets up add/delete effect lists)
+			enc_state = ENC_ACTION_EFFECT;
+			encodeTemplateEffects(tmpl);
 
-				// remain TRUE
-				z3::expr_vector addargs(*z3_context);
-				addargs.push_back(event_cascade_literal_vars[enc_litID][h][b-1]);
+			// conditions (sets up mutex lists)
+			enc_state = ENC_PROCESS_CONDITION;
+			enc_event_condition_stack = new z3::expr_vector(*z3_context);
+			enc_musts_expression_stack.clear();
+			enc_musts_discrete_stack.clear();
 
-				// event enablers
-				if(simpleEventAddEffects[enc_litID].size()>0) {
-					std::vector<int>::const_iterator iterator = simpleEventAddEffects[enc_litID].begin();
-					for (; iterator != simpleEventAddEffects[enc_litID].end(); ++iterator) {
-						addargs.push_back(event_vars[(*iterator)][h][b-1]);
-					}
-				}
+			// make process trigger
+			encodeTemplateConditions(tmpl);
 
-				// action enablers
-				if(b == opt->cascade_bound - 1) {
-					if(simpleStartAddEffects[enc_litID].size()>0 || simpleEndAddEffects[enc_litID].size()>0) {
-						std::vector<int>::const_iterator iterator = simpleStartAddEffects[enc_litID].begin();
-						for (; iterator != simpleStartAddEffects[enc_litID].end(); ++iterator) {
-							addargs.push_back(sta_action_vars[(*iterator)][h]);
-						}
-						iterator = simpleEndAddEffects[enc_litID].begin();
-						for (; iterator != simpleEndAddEffects[enc_litID].end(); ++iterator) {
-							addargs.push_back(end_action_vars[(*iterator)][h]);
-						}
-					}
-				}
-				z3_solver->add(implies(event_cascade_literal_vars[enc_litID][h][b], mk_or(addargs)));
+			z3_solver->add( run_action_vars[enc_opID][enc_expression_h] == mk_and(*enc_event_condition_stack) );
 
+			if(enc_expression_h > 0) {
 
-				// remain FALSE
-				z3::expr_vector delargs(*z3_context);
-				delargs.push_back(!event_cascade_literal_vars[enc_litID][h][b-1]);
+				// fetch half of the must conditions
+				enc_musts_expression_stack.clear();
+				enc_musts_discrete_stack.clear();
+				enc_expression_b = 0;
+				encodeTemplateConditions(tmpl);
+				enc_expression_b = opt->cascade_bound - 1;
 
-				// event disablers
-				if(simpleEventDelEffects[enc_litID].size()>0) {
-					std::vector<int>::const_iterator iterator = simpleEventDelEffects[enc_litID].begin();
-					for (; iterator != simpleEventDelEffects[enc_litID].end(); ++iterator) {
-						delargs.push_back(event_vars[(*iterator)][h][b-1]);
-					}
+				// make rest of must condition
+				std::vector<z3::expr> current;
+				current.insert(current.begin(), enc_musts_expression_stack.begin(), enc_musts_expression_stack.end());
+				enc_expression_h--;
+				enc_musts_expression_stack.clear();
+				enc_musts_discrete_stack.clear();
+				encodeTemplateConditions(tmpl);
+				enc_expression_h++;
+
+				// create boundary equations
+				z3::expr_vector mustConstraints(*z3_context);
+				while(enc_musts_expression_stack.size() > 0) {
+					mustConstraints.push_back(current.back() * enc_musts_expression_stack.back() >= 0);
+					enc_musts_expression_stack.pop_back();
+					current.pop_back();
 				}
-
-				// action disablers
-				if(b == opt->cascade_bound - 1) {
-					if(simpleStartDelEffects[enc_litID].size()>0 || simpleEndDelEffects[enc_litID].size()>0) {
-						std::vector<int>::const_iterator iterator = simpleStartDelEffects[enc_litID].begin();
-						for (; iterator != simpleStartDelEffects[enc_litID].end(); ++iterator) {
-							delargs.push_back(sta_action_vars[(*iterator)][h]);
-						}
-						iterator = simpleEndDelEffects[enc_litID].begin();
-						for (; iterator != simpleEndDelEffects[enc_litID].end(); ++iterator) {
-							delargs.push_back(end_action_vars[(*iterator)][h]);
-						}
-					}
+				while(mustConstraints.size() > 0) {
+					z3_solver->add(implies(run_action_vars[enc_opID][enc_expression_h-1], mustConstraints.back()));
+					mustConstraints.pop_back();
 				}
-				z3_solver->add(implies(!event_cascade_literal_vars[enc_litID][h][b], mk_or(delargs)));
 			}
+			delete enc_event_condition_stack;
+			enc_state = ENC_NONE;
+		}
+	}
 
-			// between happenings
-			if(h<=0) continue;
+	/*----------*/
+	/* literals */
+	/*----------*/
+
+	/**
+	 * Indexes the effect lists, which are recorded while the first layer
+	 * is encoded and are the same for every later layer.
+	 */
+	void EncoderHappening::buildSupportIndex() {
+
+		const int pneCount = Inst::instantiatedOp::howManyPNEs();
+
+		event_add_support.build(simpleEventAddEffects);
+		event_del_support.build(simpleEventDelEffects);
+		start_add_support.build(simpleStartAddEffects);
+		start_del_support.build(simpleStartDelEffects);
+		end_add_support.build(simpleEndAddEffects);
+		end_del_support.build(simpleEndDelEffects);
+		til_add_support.build(simpleTILAddEffects);
+		til_del_support.build(simpleTILDelEffects);
+		event_assign_support.build(pneCount, simpleEventAssignEffects);
+		start_assign_support.build(pneCount, simpleStartAssignEffects);
+		end_assign_support.build(pneCount, simpleEndAssignEffects);
+		til_assign_support.build(pneCount, simpleTILAssignEffects);
+	}
 
-			z3::expr_vector addargs(*z3_context);
-			addargs.push_back(event_cascade_literal_vars[enc_litID][h-1][opt->cascade_bound-1]);
+	/**
+	 * Constraints H1--H4, P5-P6 (A Compilation of the Full PDDL+ Language into SMT)
+	 * Encodes variable support in the form of explanatory frame axioms.
+	 * The value of a state variable changes only when a literal of it
+	 * becomes true, so its literals need only the axioms for becoming
+	 * true: one axiom each per level rather than two.
+	 */
+	void EncoderHappening::encodeLiteralVariableSupport(int H) {
 
-			// TIL enablers
-			if(simpleTILAddEffects[enc_litID].size()>0) {
-				std::vector<int>::const_iterator iterator = simpleTILAddEffects[enc_litID].begin();
-				for (; iterator != simpleTILAddEffects[enc_litID].end(); ++iterator) {
-					addargs.push_back(til_vars[(*iterator)][h]);
-				}
-			}
+		const int l = enc_litID;
+		const int last = opt->cascade_bound - 1;
+		const bool valued = opt->finite_domain && enc_domain_literal[l];
+		const int * e;
 
-			// become/remain TRUE
-			z3_solver->add(implies( event_cascade_literal_vars[enc_litID][h][0], mk_or(addargs) ));
+		for(int h=next_layer;h<H;h++) {
 
-			z3::expr_vector delargs(*z3_context);
-			delargs.push_back(!event_cascade_literal_vars[enc_litID][h-1][opt->cascade_bound-1]);
+			for(int b=1;b<opt->cascade_bound;b++) {
 
-			// TIL disablers
-			if(simpleTILDelEffects[enc_litID].size()>0) {
-				std::vector<int>::const_iterator iterator = simpleTILDelEffects[enc_litID].begin();
-				for (; iterator != simpleTILDelEffects[enc_litID].end(); ++iterator) {
-					delargs.push_back(til_vars[(*iterator)][h]);
+				z3::expr &prev = event_cascade_literal_vars[l][h][b-1];
+				z3::expr &curr = event_cascade_literal_vars[l][h][b];
+
+				// remain TRUE, event and action enablers
+				support_args.clear();
+				support_args.push_back(prev);
+				for(e = event_add_support.begin(l); e != event_add_support.end(l); ++e)
+					support_args.push_back(event_vars[*e][h][b-1]);
+				if(b == last) {
+					for(e = start_add_support.begin(l); e != start_add_support.end(l); ++e)
+						support_args.push_back(sta_action_vars[*e][h]);
+					for(e = end_add_support.begin(l); e != end_add_support.end(l); ++e)
+						support_args.push_back(end_action_vars[*e][h]);
+				}
+				z3_solver->add(implies(curr, mk_or(support_args)));
+				if(valued) continue;
+
+				// remain FALSE, event and action disablers
+				z3::expr notPrev = !prev;
+				support_args.clear();
+				support_args.push_back(notPrev);
+				for(e = event_del_support.begin(l); e != event_del_support.end(l); ++e)
+					support_args.push_back(event_vars[*e][h][b-1]);
+				if(b == last) {
+					for(e = start_del_support.begin(l); e != start_del_support.end(l); ++e)
+						support_args.push_back(sta_action_vars[*e][h]);
+					for(e = end_del_support.begin(l); e != end_del_support.end(l); ++e)
+						support_args.push_back(end_action_vars[*e][h]);
 				}
+				z3_solver->add(implies(!curr, mk_or(support_args)));
 			}
 
-			// become/remain FALSE
-			z3_solver->add(implies( !event_cascade_literal_vars[enc_litID][h][0], mk_or(delargs) ));
+			// between happenings
+			if(h<=0) continue;
+
+			z3::expr &prev = event_cascade_literal_vars[l][h-1][last];
+			z3::expr &curr = event_cascade_literal_vars[l][h][0];
+
+			// become/remain TRUE, TIL enablers
+			support_args.clear();
+			support_args.push_back(prev);
+			for(e = til_add_support.begin(l); e != til_add_support.end(l); ++e)
+				support_args.push_back(til_vars[*e][h]);
+			z3_solver->add(implies(curr, mk_or(support_args)));
+			if(valued) continue;
+
+			// become/remain FALSE, TIL disablers
+			z3::expr notPrev = !prev;
+			support_args.clear();
+			support_args.push_back(notPrev);
+			for(e = til_del_support.begin(l); e != til_del_support.end(l); ++e)
+				support_args.push_back(til_vars[*e][h]);
+			z3_solver->add(implies(!curr, mk_or(support_args)));
 		}
 	}
 
@@ -817,36 +1162,27 @@ namespace SMTPlan {
 	 */
 	void EncoderHappening::encodeFunctionVariableSupport(int H) {
 
+		const int f = enc_pneID;
+		const int last = opt->cascade_bound - 1;
+		const int * e;
+
 		for(int h=next_layer;h<H;h++) {
 
 			for(int b=1;b<opt->cascade_bound;b++) {
 
-				// remain or assign
-				z3::expr_vector chargs(*z3_context);
-
-				// event assigners
-				if(simpleEventAssignEffects[enc_pneID].size()>0) {
-					std::vector<std::pair<int, z3::expr> >::const_iterator iterator = simpleEventAssignEffects[enc_pneID].begin();
-					for (; iterator != simpleEventAssignEffects[enc_pneID].end(); ++iterator) {
-						chargs.push_back(event_vars[iterator->first][h][b-1]);
-					}
+				// remain or assign, event and action assigners
+				z3::expr unchanged = (event_cascade_function_vars[f][h][b-1] == event_cascade_function_vars[f][h][b]);
+				support_args.clear();
+				for(e = event_assign_support.begin(f); e != event_assign_support.end(f); ++e)
+					support_args.push_back(event_vars[*e][h][b-1]);
+				if(b == last) {
+					for(e = start_assign_support.begin(f); e != start_assign_support.end(f); ++e)
+						support_args.push_back(sta_action_vars[*e][h]);
+					for(e = end_assign_support.begin(f); e != end_assign_support.end(f); ++e)
+						support_args.push_back(end_action_vars[*e][h]);
 				}
-
-				// action assigners
-				if(b == opt->cascade_bound - 1) {
-					if(simpleStartAssignEffects[enc_pneID].size()>0 || simpleEndAssignEffects[enc_pneID].size()>0) {
-						std::vector<std::pair<int, z3::expr> >::const_iterator iterator = simpleStartAssignEffects[enc_pneID].begin();
-						for (; iterator != simpleStartAssignEffects[enc_pneID].end(); ++iterator) {
-							chargs.push_back(sta_action_vars[iterator->first][h]);
-						}
-						iterator = simpleEndAssignEffects[enc_pneID].begin();
-						for (; iterator != simpleEndAssignEffects[enc_pneID].end(); ++iterator) {
-							chargs.push_back(end_action_vars[iterator->first][h]);
-						}
-					}
-				}
-				chargs.push_back(event_cascade_function_vars[enc_pneID][h][b-1] == event_cascade_function_vars[enc_pneID][h][b]);
-				z3_solver->add(mk_or(chargs));
+				support_args.push_back(unchanged);
+				z3_solver->add(mk_or(support_args));
 			}
 		}
 	}
@@ -870,11 +1206,9 @@ namespace SMTPlan {
 				chargs.push_back(event_cascade_function_vars[enc_pneID][h][0] == event_cascade_function_vars[enc_pneID][h-1][opt->cascade_bound-1]);
 
 				// TIL assigners
-				if(simpleTILAssignEffects[enc_pneID].size()>0) {
-					std::vector<std::pair<int, z3::expr> >::const_iterator iterator = simpleTILAssignEffects[enc_pneID].begin();
-					for (; iterator != simpleTILAssignEffects[enc_pneID].end(); ++iterator) {
-						chargs.push_back(til_vars[iterator->first][h]);
-					}
+				const int * e = til_assign_support.begin(enc_pneID);
+				for (; e != til_assign_support.end(enc_pneID); ++e) {
+					chargs.push_back(til_vars[*e][h]);
 				}
 
 				z3_solver->add(mk_or(chargs));
@@ -884,11 +1218,9 @@ namespace SMTPlan {
 			// TIL assigners
 			z3::expr_vector til_chargs(*z3_context);
 			til_chargs.push_back(z3_context->bool_val(true));
-			if(simpleTILAssignEffects[enc_pneID].size()>0) {
-				std::vector<std::pair<int, z3::expr> >::const_iterator iterator = simpleTILAssignEffects[enc_pneID].begin();
-				for (; iterator != simpleTILAssignEffects[enc_pneID].end(); ++iterator) {
-					til_chargs.push_back(!til_vars[iterator->first][h]);
-				}
+			const int * e = til_assign_support.begin(enc_pneID);
+			for (; e != til_assign_support.end(enc_pneID); ++e) {
+				til_chargs.push_back(!til_vars[*e][h]);
 			}
 
 			bool nchargsSet = false;
@@ -945,6 +1277,7 @@ namespace SMTPlan {
 
 		Inst::Literal * l = new Inst::Literal(c->getProp(), fe);
 		Inst::Literal * const lit = Inst::instantiatedOp::findLiteral(l);
+		delete l;
 
 		if(!lit) {
 			if(enc_state == ENC_GOAL) goal_expression.push_back(z3_context->bool_val(false));
@@ -963,35 +1296,53 @@ namespace SMTPlan {
 
 		case ENC_EVENT_CONDITION:
 		case ENC_PROCESS_CONDITION:
-
-			if(problem_info->staticPredicateMap[lit->getHead()->getName()]) {
-				enc_event_condition_stack->push_back(z3_context->bool_val(true));
-				break;
+		case ENC_ACTION_CONDITION:
+			// static conditions hold in every state
+			if(problem_info->staticPredicateMap[lit->getHead()->getName()]) break;
+			// fall through
+		case ENC_SIMPLE_ACTION_CONDITION:
+			{
+				LiteralTemplate cond = {lit->getID(), enc_cond_neg, enc_cond_time};
+				enc_template->conditions.push_back(cond);
 			}
+			break;
 
+		default:
+			std::cerr << "Visit simple goal without correct state! (" << enc_state << ")" << std::endl;
+			break;
+		}
+	}
+
+	/* encodes a literal condition of the operator enc_opID at happening enc_expression_h */
+	void EncoderHappening::encodeLiteralCondition(int litID) {
+
+		switch(enc_state) {
+
+		case ENC_EVENT_CONDITION:
+		case ENC_PROCESS_CONDITION:
 			if(enc_cond_neg) {
-				enc_event_condition_stack->push_back(!event_cascade_literal_vars[lit->getID()][enc_expression_h][enc_expression_b]);
-				enc_musts_discrete_stack.push_back(event_cascade_literal_vars[lit->getID()][enc_expression_h][enc_expression_b]);
+				enc_event_condition_stack->push_back(!event_cascade_literal_vars[litID][enc_expression_h][enc_expression_b]);
+				enc_musts_discrete_stack.push_back(event_cascade_literal_vars[litID][enc_expression_h][enc_expression_b]);
 			} else {
-				enc_event_condition_stack->push_back(event_cascade_literal_vars[lit->getID()][enc_expression_h][enc_expression_b]);
-				enc_musts_discrete_stack.push_back(!event_cascade_literal_vars[lit->getID()][enc_expression_h][enc_expression_b]);
+				enc_event_condition_stack->push_back(event_cascade_literal_vars[litID][enc_expression_h][enc_expression_b]);
+				enc_musts_discrete_stack.push_back(!event_cascade_literal_vars[litID][enc_expression_h][enc_expression_b]);
 			}
 			break;
 
 		case ENC_SIMPLE_ACTION_CONDITION:
 			if(enc_cond_neg) {
-				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 				// mutual exclusion
-				std::vector<int>::const_iterator iterator = simpleStartAddEffects[lit->getID()].begin();
-				for (; iterator != simpleStartAddEffects[lit->getID()].end(); ++iterator) {
+				std::vector<int>::const_iterator iterator = simpleStartAddEffects[litID].begin();
+				for (; iterator != simpleStartAddEffects[litID].end(); ++iterator) {
 					if((*iterator) == enc_opID) continue;
 					z3_solver->add(!sta_action_vars[enc_opID][enc_expression_h] || !sta_action_vars[(*iterator)][enc_expression_h]);
 				}
 			} else {
-				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 				// mutual exclusion
-				std::vector<int>::const_iterator iterator = simpleStartDelEffects[lit->getID()].begin();
-				for (; iterator != simpleStartDelEffects[lit->getID()].end(); ++iterator) {
+				std::vector<int>::const_iterator iterator = simpleStartDelEffects[litID].begin();
+				for (; iterator != simpleStartDelEffects[litID].end(); ++iterator) {
 					if((*iterator) == enc_opID) continue;
 					z3_solver->add(!sta_action_vars[enc_opID][enc_expression_h] || !sta_action_vars[(*iterator)][enc_expression_h]);
 				}
@@ -999,27 +1350,24 @@ namespace SMTPlan {
 			break;
 
 		case ENC_ACTION_CONDITION:
-			if(problem_info->staticPredicateMap[lit->getHead()->getName()]) {
-				break;
-			}
 			switch(enc_cond_time) {
 			case VAL::E_AT_START:
 
 				if(enc_cond_neg) {
 
-					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 					// mutual exclusion
-					std::vector<int>::const_iterator iterator = simpleStartAddEffects[lit->getID()].begin();
-					for (; iterator != simpleStartAddEffects[lit->getID()].end(); ++iterator) {
+					std::vector<int>::const_iterator iterator = simpleStartAddEffects[litID].begin();
+					for (; iterator != simpleStartAddEffects[litID].end(); ++iterator) {
 						if((*iterator) == enc_opID) continue;
 						z3_solver->add(!sta_action_vars[enc_opID][enc_expression_h] || !sta_action_vars[(*iterator)][enc_expression_h]);
 					}
 				} else {
 
-					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 					// mutual exclusion
-					std::vector<int>::const_iterator iterator = simpleStartDelEffects[lit->getID()].begin();
-					for (; iterator != simpleStartDelEffects[lit->getID()].end(); ++iterator) {
+					std::vector<int>::const_iterator iterator = simpleStartDelEffects[litID].begin();
+					for (; iterator != simpleStartDelEffects[litID].end(); ++iterator) {
 						if((*iterator) == enc_opID) continue;
 						z3_solver->add(!sta_action_vars[enc_opID][enc_expression_h] || !sta_action_vars[(*iterator)][enc_expression_h]);
 					}
@@ -1027,30 +1375,48 @@ namespace SMTPlan {
 				break;
 			case VAL::E_AT_END:
 				if(enc_cond_neg) {
-					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 				} else {
-					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 				}
 				break;
 			case VAL::E_OVER_ALL:
 				if(enc_cond_neg) {
-					z3_solver->add(implies(run_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+					z3_solver->add(implies(run_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 				} else {
-					z3_solver->add(implies(run_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-2]));
+					z3_solver->add(implies(run_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-2]));
 				}
 				break;
 			}
 			break;
+
 		default:
-			std::cerr << "Visit simple goal without correct state! (" << enc_state << ")" << std::endl;
 			break;
 		}
-
-		delete l;
 	}
 
 	void EncoderHappening::visit_comparison(VAL::comparison * c) {
 
+		// operator conditions and durations are compiled into the template
+		if(enc_template) {
+
+			ComparisonTemplate cmp;
+			cmp.op = c->getOp();
+			cmp.time = enc_cond_time;
+
+			enc_template_expression = &cmp.lhs;
+			c->getLHS()->visit(this);
+			enc_template_expression = &cmp.rhs;
+			c->getRHS()->visit(this);
+			enc_template_expression = NULL;
+
+			if(enc_state == ENC_ACTION_DURATION)
+				enc_template->duration.push_back(cmp);
+			else
+				enc_template->comparisons.push_back(cmp);
+			return;
+		}
+
 		enc_expression_stack.clear();
 
 		// generate SMT expression
@@ -1062,9 +1428,20 @@ namespace SMTPlan {
 		z3::expr lhs = enc_expression_stack.back();
 		enc_expression_stack.pop_back();
 
+		encodeComparison(lhs, rhs, c->getOp());
+	}
+
+	/* encodes a numeric condition or duration constraint of the operator enc_opID */
+	void EncoderHappening::encodeComparison(const ComparisonTemplate &cmp) {
+		enc_cond_time = cmp.time;
+		encodeComparison(mk_template_expr(cmp.lhs), mk_template_expr(cmp.rhs), cmp.op);
+	}
+
+	void EncoderHappening::encodeComparison(const z3::expr &lhs, const z3::expr &rhs, VAL::comparison_op op) {
+
 		// generate SMT comparison
 		z3::expr com = (rhs == lhs);
-		switch(c->getOp()) {
+		switch(op) {
 		case VAL::E_GREATER: com = (lhs > rhs); break;
 		case VAL::E_GREATEQ: com = (lhs >= rhs); break;
 		case VAL::E_LESS: com = (lhs < rhs); break;
@@ -1076,9 +1453,7 @@ namespace SMTPlan {
 
 		case ENC_GOAL:
 			{
-				std::stringstream ss;
-				ss << com;
-				z3::expr g = z3_context->bool_const(ss.str().c_str());
+				z3::expr g = var_factory->mk_bool(enc_goal_name, enc_goal_count++, "");
 				z3_solver->add(implies(g,com));
 				goal_expression.push_back(g);
 			}
@@ -1150,50 +1525,71 @@ namespace SMTPlan {
 	void EncoderHappening::visit_simple_effect(VAL::simple_effect * e) {
 		Inst::Literal * l = new Inst::Literal(e->prop, fe);
 		Inst::Literal * const lit = Inst::instantiatedOp::findLiteral(l);
+		delete l;
 
 		if (!lit) return;
 
 		switch(enc_state) {
 
-		case ENC_EVENT_EFFECT:
+		case ENC_TIL_EFFECT:
+
+			problem_info->staticPredicateMap[lit->getHead()->getName()] = false;
 			if(enc_eff_neg) {
-				z3_solver->add(implies(
-						event_vars[enc_opID][enc_expression_h][enc_expression_b],
-						!event_cascade_literal_vars[lit->getID()][enc_expression_h][enc_expression_b+1]));
+				z3_solver->add(implies(til_vars[enc_tilID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][0]));
 				// save del effect for literal support later
-				if(enc_expression_h==0 && enc_expression_b==0) simpleEventDelEffects[lit->getID()].push_back(enc_opID);
+				if(enc_expression_h==0) simpleTILDelEffects[lit->getID()].push_back(enc_tilID);
 			} else {
-				z3_solver->add(implies(
-						event_vars[enc_opID][enc_expression_h][enc_expression_b],
-						event_cascade_literal_vars[lit->getID()][enc_expression_h][enc_expression_b+1]));
+				z3_solver->add(implies(til_vars[enc_tilID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][0]));
 				// save add effect for literal support later
-				if(enc_expression_h==0 && enc_expression_b==0) simpleEventAddEffects[lit->getID()].push_back(enc_opID);
+				if(enc_expression_h==0) simpleTILAddEffects[lit->getID()].push_back(enc_tilID);
 			}
 			break;
 
+		case ENC_EVENT_EFFECT:
 		case ENC_SIMPLE_ACTION_EFFECT:
+		case ENC_ACTION_EFFECT:
+			{
+				LiteralTemplate eff = {lit->getID(), enc_eff_neg, enc_eff_time};
+				enc_template->effects.push_back(eff);
+			}
+			break;
+
+		default:
+			std::cerr << "Visit effects without correct state! (" << enc_state << ")" << std::endl;
+			break;
+		}
+	}
+
+	/* encodes a literal effect of the operator enc_opID at happening enc_expression_h */
+	void EncoderHappening::encodeLiteralEffect(int litID) {
+
+		switch(enc_state) {
+
+		case ENC_EVENT_EFFECT:
 			if(enc_eff_neg) {
-				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-1]));
+				z3_solver->add(implies(
+						event_vars[enc_opID][enc_expression_h][enc_expression_b],
+						!event_cascade_literal_vars[litID][enc_expression_h][enc_expression_b+1]));
 				// save del effect for literal support later
-				if(enc_expression_h==0) simpleStartDelEffects[lit->getID()].push_back(enc_opID);
+				if(enc_expression_h==0 && enc_expression_b==0) simpleEventDelEffects[litID].push_back(enc_opID);
 			} else {
-				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-1]));
+				z3_solver->add(implies(
+						event_vars[enc_opID][enc_expression_h][enc_expression_b],
+						event_cascade_literal_vars[litID][enc_expression_h][enc_expression_b+1]));
 				// save add effect for literal support later
-				if(enc_expression_h==0) simpleStartAddEffects[lit->getID()].push_back(enc_opID);
+				if(enc_expression_h==0 && enc_expression_b==0) simpleEventAddEffects[litID].push_back(enc_opID);
 			}
 			break;
 
-		case ENC_TIL_EFFECT:
-
-			problem_info->staticPredicateMap[lit->getHead()->getName()] = false;
+		case ENC_SIMPLE_ACTION_EFFECT:
 			if(enc_eff_neg) {
-				z3_solver->add(implies(til_vars[enc_tilID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][0]));
+				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-1]));
 				// save del effect for literal support later
-				if(enc_expression_h==0) simpleTILDelEffects[lit->getID()].push_back(enc_tilID);
+				if(enc_expression_h==0) simpleStartDelEffects[litID].push_back(enc_opID);
 			} else {
-				z3_solver->add(implies(til_vars[enc_tilID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][0]));
+				z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-1]));
 				// save add effect for literal support later
-				if(enc_expression_h==0) simpleTILAddEffects[lit->getID()].push_back(enc_tilID);
+				if(enc_expression_h==0) simpleStartAddEffects[litID].push_back(enc_opID);
 			}
 			break;
 
@@ -1201,44 +1597,60 @@ namespace SMTPlan {
 			switch(enc_eff_time) {
 			case VAL::E_AT_START:
 				if(enc_eff_neg) {
-					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-1]));
+					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-1]));
 					// save del effect for literal support later
-					if(enc_expression_h==0) simpleStartDelEffects[lit->getID()].push_back(enc_opID);
+					if(enc_expression_h==0) simpleStartDelEffects[litID].push_back(enc_opID);
 				} else {
-					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-1]));
+					z3_solver->add(implies(sta_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-1]));
 					// save add effect for literal support later
-					if(enc_expression_h==0) simpleStartAddEffects[lit->getID()].push_back(enc_opID);
+					if(enc_expression_h==0) simpleStartAddEffects[litID].push_back(enc_opID);
 				}
 				break;
 			case VAL::E_AT_END:
 				if(enc_eff_neg) {
-					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-1]));
+					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], !event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-1]));
 					// save del effect for literal support later
-					if(enc_expression_h==0) simpleEndDelEffects[lit->getID()].push_back(enc_opID);
+					if(enc_expression_h==0) simpleEndDelEffects[litID].push_back(enc_opID);
 				} else {
-					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[lit->getID()][enc_expression_h][opt->cascade_bound-1]));
+					z3_solver->add(implies(end_action_vars[enc_opID][enc_expression_h], event_cascade_literal_vars[litID][enc_expression_h][opt->cascade_bound-1]));
 					// save add effect for literal support later
-					if(enc_expression_h==0) simpleEndAddEffects[lit->getID()].push_back(enc_opID);
+					if(enc_expression_h==0) simpleEndAddEffects[litID].push_back(enc_opID);
 				}
 				break;
 			}
 			break;
 
 		default:
-			std::cerr << "Visit effects without correct state! (" << enc_state << ")" << std::endl;
 			break;
 		}
-
-		delete l;
 	}
 
 	void EncoderHappening::visit_assignment(VAL::assignment * e) {
 
 		Inst::PNE * l = new Inst::PNE(e->getFTerm(), fe);	
 		Inst::PNE * const lit = Inst::instantiatedOp::findPNE(l);
+		delete l;
 
 		if (!lit) return;
 
+		// operator effects are compiled into the template
+		if(enc_template) {
+
+			AssignmentTemplate assign;
+			assign.function = lit->getID();
+			assign.op = e->getOp();
+			assign.time = enc_eff_time;
+
+			enc_continuous = false;
+			enc_template_expression = &assign.value;
+			e->getExpr()->visit(this);
+			enc_template_expression = NULL;
+
+			// continuous effects are encoded as flows
+			if(!enc_continuous) enc_template->assignments.push_back(assign);
+			return;
+		}
+
 		// value
 		enc_continuous = false;
 		e->getExpr()->visit(this);
@@ -1250,9 +1662,14 @@ namespace SMTPlan {
 		z3::expr expr = enc_expression_stack.back();
 		enc_expression_stack.pop_back();
 
-		// function
-		enc_pneID = lit->getID();
-		enc_function_symbol = l->getHead()->getName();
+		problem_info->staticFunctionMap[lit->getHead()->getName()] = false;
+		encodeAssignment(lit->getID(), e->getOp(), expr);
+	}
+
+	/* encodes a discrete numeric effect of the operator enc_opID, or of the TIL enc_tilID */
+	void EncoderHappening::encodeAssignment(int pneID, VAL::assign_op op, const z3::expr &expr) {
+
+		enc_pneID = pneID;
 		z3::expr * opExpr;
 		switch(enc_state) {
 
@@ -1260,8 +1677,8 @@ namespace SMTPlan {
 
 			opExpr = &event_vars[enc_opID][enc_expression_h][enc_expression_b];
 			if(enc_expression_h==0 && enc_expression_b == 0) {
-				simpleEventAssignEffects[lit->getID()];
-				simpleEventAssignEffects[lit->getID()].push_back(std::pair<int,z3::expr>(enc_opID, expr));
+				simpleEventAssignEffects[pneID];
+				simpleEventAssignEffects[pneID].push_back(std::pair<int,z3::expr>(enc_opID, expr));
 			}
 			break;
 
@@ -1272,38 +1689,38 @@ namespace SMTPlan {
 			case VAL::E_AT_START:
 				opExpr = &sta_action_vars[enc_opID][enc_expression_h];
 				if(enc_expression_h==0) {
-					simpleStartAssignEffects[lit->getID()];
-					simpleStartAssignEffects[lit->getID()].push_back(std::pair<int,z3::expr>(enc_opID, expr));
+					simpleStartAssignEffects[pneID];
+					simpleStartAssignEffects[pneID].push_back(std::pair<int,z3::expr>(enc_opID, expr));
 				}
 				break;
 			case VAL::E_AT_END:
 				opExpr = &end_action_vars[enc_opID][enc_expression_h];
 				if(enc_expression_h==0) {
-					simpleEndAssignEffects[lit->getID()];
-					simpleEndAssignEffects[lit->getID()].push_back(std::pair<int,z3::expr>(enc_opID, expr));
+					simpleEndAssignEffects[pneID];
+					simpleEndAssignEffects[pneID].push_back(std::pair<int,z3::expr>(enc_opID, expr));
 				}
 				break;
 
 			default:
 				std::cerr << "Visit assignment without time spec!" << std::endl;
-				break;
+				return;
 			}
 			break;
 
-			case ENC_TIL_EFFECT:
-				opExpr = &til_vars[enc_tilID][enc_expression_h];
-				if(enc_expression_h==0) {
-					simpleTILAssignEffects[lit->getID()];
-					simpleTILAssignEffects[lit->getID()].push_back(std::pair<int,z3::expr>(enc_tilID, expr));
-				}
-				problem_info->staticFunctionMap[lit->getHead()->getName()] = false;
-				break;
-
+		case ENC_TIL_EFFECT:
+			opExpr = &til_vars[enc_tilID][enc_expression_h];
+			if(enc_expression_h==0) {
+				simpleTILAssignEffects[pneID];
+				simpleTILAssignEffects[pneID].push_back(std::pair<int,z3::expr>(enc_tilID, expr));
+			}
 			break;
+
+		default:
+			std::cerr << "Visit assignment without correct state! (" << enc_state << ")" << std::endl;
+			return;
 		}
 
 		// operator
-		VAL::assign_op op = e->getOp();
 		switch(op) {
 		case VAL::E_ASSIGN:
 			if(enc_state == ENC_TIL_EFFECT)
@@ -1335,11 +1752,10 @@ namespace SMTPlan {
 			std::cerr << "not implemented assign CTS" << std::endl;
 			break;
 		}
-		delete l;
 	}
 
-	void EncoderHappening::visit_forall_effect(VAL::forall_effect * e) {std::cout << "not implemented forall" << std::endl;};
-	void EncoderHappening::visit_cond_effect(VAL::cond_effect * e) {std::cout << "not implemented cond" << std::endl;};
+	void EncoderHappening::visit_forall_effect(VAL::forall_effect * e) {std::cerr << "not implemented forall" << std::endl;};
+	void EncoderHappening::visit_cond_effect(VAL::cond_effect * e) {std::cerr << "not implemented cond" << std::endl;};
 
 	/*-------------*/
 	/* expressions */
@@ -1349,11 +1765,63 @@ namespace SMTPlan {
 		e->visit(this);
 	}
 
+	/**
+	 * Builds a compiled expression at happening enc_expression_h and cascade
+	 * level enc_expression_b, as visiting it would have.
+	 */
+	z3::expr EncoderHappening::mk_template_expr(const std::vector<ExpressionNode> &nodes) {
+
+		std::vector<z3::expr> stack;
+		std::vector<ExpressionNode>::const_iterator it = nodes.begin();
+		for(; it != nodes.end(); ++it) {
+
+			if(it->kind == EXPR_CONSTANT) {
+				stack.push_back(template_constants[it->id]);
+				continue;
+			}
+			if(it->kind == EXPR_FUNCTION) {
+				stack.push_back(event_cascade_function_vars[it->id][enc_expression_h][enc_expression_b]);
+				continue;
+			}
+			if(it->kind == EXPR_DURATION) {
+				stack.push_back(dur_action_vars[enc_opID][enc_expression_h]);
+				continue;
+			}
+			if(it->kind == EXPR_UMINUS) {
+				z3::expr exp = stack.back();
+				stack.pop_back();
+				stack.push_back(-exp);
+				continue;
+			}
+
+			z3::expr last = stack.back();
+			stack.pop_back();
+			z3::expr first = stack.back();
+			stack.pop_back();
+
+			switch(it->kind) {
+			case EXPR_PLUS: stack.push_back(last + first); break;
+			case EXPR_MINUS: stack.push_back(last - first); break;
+			case EXPR_MUL: stack.push_back(last * first); break;
+			case EXPR_DIV: stack.push_back(first / last); break;
+			default: break;
+			}
+		}
+
+		if(stack.empty()) return z3_context->real_val(0);
+		return stack.back();
+	}
+
 	void EncoderHappening::visit_plus_expression(VAL::plus_expression * s) {
 
 		s->getLHS()->visit(this);
 		s->getRHS()->visit(this);
 
+		if(enc_template_expression) {
+			mk_template_node(EXPR_PLUS, 0);
+			return;
+		}
+
 		z3::expr lhs = enc_expression_stack.back();
 		enc_expression_stack.pop_back();
 		z3::expr rhs = enc_expression_stack.back();
@@ -1366,6 +1834,11 @@ namespace SMTPlan {
 		s->getLHS()->visit(this);
 		s->getRHS()->visit(this);
 
+		if(enc_template_expression) {
+			mk_template_node(EXPR_MINUS, 0);
+			return;
+		}
+
 		z3::expr lhs = enc_expression_stack.back();
 		enc_expression_stack.pop_back();
 		z3::expr rhs = enc_expression_stack.back();
@@ -1378,6 +1851,11 @@ namespace SMTPlan {
 		s->getLHS()->visit(this);
 		s->getRHS()->visit(this);
 
+		if(enc_template_expression) {
+			mk_template_node(EXPR_MUL, 0);
+			return;
+		}
+
 		z3::expr lhs = enc_expression_stack.back();
 		enc_expression_stack.pop_back();
 		z3::expr rhs = enc_expression_stack.back();
@@ -1390,6 +1868,11 @@ namespace SMTPlan {
 		s->getLHS()->visit(this);
 		s->getRHS()->visit(this);
 
+		if(enc_template_expression) {
+			mk_template_node(EXPR_DIV, 0);
+			return;
+		}
+
 		z3::expr rhs = enc_expression_stack.back();
 		enc_expression_stack.pop_back();
 		z3::expr lhs = enc_expression_stack.back();
@@ -1401,6 +1884,11 @@ namespace SMTPlan {
 
 		s->getExpr()->visit(this);
 
+		if(enc_template_expression) {
+			mk_template_node(EXPR_UMINUS, 0);
+			return;
+		}
+
 		z3::expr exp = enc_expression_stack.back();
 		enc_expression_stack.pop_back();
 		enc_expression_stack.push_back(-exp);
@@ -1411,7 +1899,8 @@ namespace SMTPlan {
 		std::stringstream ss;
 		ss << s->double_value();
 		z3::expr dv = z3_context->real_val(ss.str().c_str());
-		enc_expression_stack.push_back(dv);
+		if(enc_template_expression) mk_template_constant(dv);
+		else enc_expression_stack.push_back(dv);
 	}
 
 	void EncoderHappening::visit_float_expression(VAL::float_expression * s) {
@@ -1419,39 +1908,42 @@ namespace SMTPlan {
 		std::stringstream ss;
 		ss << s->double_value();
 		z3::expr dv = z3_context->real_val(ss.str().c_str());
-		enc_expression_stack.push_back(dv);
+		if(enc_template_expression) mk_template_constant(dv);
+		else enc_expression_stack.push_back(dv);
 	}
 
 	void EncoderHappening::visit_func_term(VAL::func_term * s) {
 		Inst::PNE * l = new Inst::PNE(s, fe);
 		Inst::PNE * const lit = Inst::instantiatedOp::findPNE(l);
+		delete l;
 
 		if (!lit) {
 			z3::expr dv = z3_context->real_val(0);
-			enc_expression_stack.push_back(dv);
-			delete l;
+			if(enc_template_expression) mk_template_constant(dv);
+			else enc_expression_stack.push_back(dv);
+			return;
+		}
+
+		const bool isStatic = problem_info->staticFunctionMap[lit->getHead()->getName()];
+
+		// operator expressions are compiled into the template
+		if(enc_template_expression) {
+			if(isStatic) mk_template_constant(problem_info->staticFunctionValues.find(lit->getID())->second);
+			else mk_template_node(EXPR_FUNCTION, lit->getID());
 			return;
 		}
 
 		switch(enc_state) {
 
 		case ENC_GOAL:
-			if(problem_info->staticFunctionMap[l->getHead()->getName()]) {
+			if(isStatic) {
 				enc_expression_stack.push_back(problem_info->staticFunctionValues.find(lit->getID())->second);
 			} else {
 				enc_expression_stack.push_back(event_cascade_function_vars[lit->getID()][enc_expression_h][opt->cascade_bound-1]);
 			}
 			break;
-		case ENC_ACTION_DURATION:
-		case ENC_ACTION_CONDITION:
-		case ENC_ACTION_EFFECT:
-		case ENC_SIMPLE_ACTION_CONDITION:
-		case ENC_SIMPLE_ACTION_EFFECT:
-		case ENC_EVENT_EFFECT:
 		case ENC_TIL_EFFECT:
-		case ENC_EVENT_CONDITION:
-		case ENC_PROCESS_CONDITION:
-			if(problem_info->staticFunctionMap[lit->getHead()->getName()]) {
+			if(isStatic) {
 				enc_expression_stack.push_back(problem_info->staticFunctionValues.find(lit->getID())->second);
 			} else {
 				enc_expression_stack.push_back(event_cascade_function_vars[lit->getID()][enc_expression_h][enc_expression_b]);
@@ -1462,7 +1954,6 @@ namespace SMTPlan {
 			std::cerr << "Visit func_term expression without correct state! (" << enc_state << ")" << std::endl;
 			break;
 		}
-		delete l;
 	}
 
 	void EncoderHappening::visit_special_val_expr(VAL::special_val_expr * s) {
@@ -1474,11 +1965,9 @@ namespace SMTPlan {
 
 			case ENC_ACTION_DURATION:
 			case ENC_ACTION_CONDITION:
-				enc_expression_stack.push_back(dur_action_vars[enc_opID][enc_expression_h]);
-				break;
-
 			case ENC_ACTION_EFFECT:
-				enc_expression_stack.push_back(dur_action_vars[enc_opID][enc_expression_h]);
+				if(enc_template_expression) mk_template_node(EXPR_DURATION, 0);
+				else enc_expression_stack.push_back(dur_action_vars[enc_opID][enc_expression_h]);
 				break;
 
 			default:
@@ -1491,7 +1980,8 @@ namespace SMTPlan {
 			enc_continuous = true;
 			switch(enc_state) {
 			case ENC_ACTION_EFFECT:
-				enc_expression_stack.push_back(dur_action_vars[enc_opID][enc_expression_h]);
+				if(enc_template_expression) mk_template_node(EXPR_DURATION, 0);
+				else enc_expression_stack.push_back(dur_action_vars[enc_opID][enc_expression_h]);
 				break;
 			}
 			break;
@@ -0,0 +1,267 @@
+#include "SMTPlan/EncodingCache.h"
+
+/* implementation of SMTPlan::EncodingCache */
+namespace SMTPlan {
+
+	/**
+	 * The key covers the files and every option that changes the
+	 * encoding of a horizon. Bounds, step size and solving options do not.
+	 */
+	EncodingCache::EncodingCache(PlannerOptions &options) {
+
+		opt = &options;
+		cache_context = NULL;
+		cache_solver = NULL;
+
+		if(opt->cache_dir == "") return;
+
+		std::string domain, problem;
+		if(!readFile(opt->domain_path, domain) || !readFile(opt->problem_path, problem)) {
+			std::cerr << "Cannot read problem files, encoding cache disabled" << std::endl;
+			return;
+		}
+
+		std::stringstream encoding;
+		encoding << "encoder " << opt->encoder << " cascade " << opt->cascade_bound
+				<< " reachability " << opt->reachability << " layered " << opt->layered
+				<< " mutex " << opt->mutex_groups << " domains " << opt->finite_domain
+				<< " symmetry " << opt->symmetry;
+
+		unsigned long long key = hash(domain);
+		key = hash(std::string(1, '\0'), key);
+		key = hash(problem, key);
+		key = hash(std::string(1, '\0'), key);
+		key = hash(encoding.str(), key);
+
+		char name[17];
+		snprintf(name, sizeof(name), "%016llx", key);
+
+		mkdir(opt->cache_dir.c_str(), 0755);
+		path = opt->cache_dir + "/" + name;
+		mkdir(path.c_str(), 0755);
+
+		// plans are stored as printed, possibly by several search threads
+		z3::set_param("pp.decimal", true);
+	}
+
+	EncodingCache::~EncodingCache() {
+		cache_steps.clear();
+		if(cache_solver) delete cache_solver;
+		if(cache_context) delete cache_context;
+	}
+
+	unsigned long long EncodingCache::hash(const std::string &data, unsigned long long hash) {
+		for(std::string::size_type i=0; i<data.size(); i++) {
+			hash ^= (unsigned char)data[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	std::string EncodingCache::horizonFile(int H, const char * extension) {
+		std::stringstream ss;
+		ss << path << "/" << H << extension;
+		return ss.str();
+	}
+
+	bool EncodingCache::readFile(const std::string &file, std::string &contents) {
+		std::ifstream in(file.c_str(), std::ios::in | std::ios::binary);
+		if(!in.good()) return false;
+		std::stringstream ss;
+		ss << in.rdbuf();
+		contents = ss.str();
+		return true;
+	}
+
+	/**
+	 * Files are written beside their destination and renamed into
+	 * place, so a run sharing the cache never reads a partial file.
+	 */
+	void EncodingCache::writeFile(const std::string &file, const std::string &contents) {
+		std::stringstream tmp;
+		tmp << file << "." << getpid() << ".tmp";
+		std::ofstream out(tmp.str().c_str(), std::ios::out | std::ios::binary);
+		out << contents;
+		out.close();
+		if(!out.good() || std::rename(tmp.str().c_str(), file.c_str()) != 0) {
+			std::remove(tmp.str().c_str());
+			std::cerr << "Cannot write " << file << std::endl;
+		}
+	}
+
+	bool EncodingCache::has(int H) {
+		if(!enabled()) return false;
+		std::ifstream in(horizonFile(H, ".plan").c_str());
+		return in.good();
+	}
+
+	/*---------*/
+	/* storing */
+	/*---------*/
+
+	/* the name of a constant as it appears in smt2, without quotes */
+	static std::string symbolName(const z3::expr &var) {
+		std::stringstream ss;
+		ss << var;
+		std::string name = ss.str();
+		if(name.size() > 1 && name[0] == '|')
+			return name.substr(1, name.size() - 2);
+		return name;
+	}
+
+	/**
+	 * The plan file is written last, so a horizon is only in the
+	 * cache once both of its files are.
+	 */
+	void EncodingCache::store(int H, Encoder * encoder, bool linear) {
+
+		if(!enabled()) return;
+
+		// encoding, with the goal asserted
+		z3::expr_vector fmls = encoder->z3_solver->assertions();
+		std::vector<z3::expr> &goal = encoder->getGoal();
+		for(unsigned int i=0; i<goal.size(); i++)
+			fmls.push_back(goal[i]);
+
+		std::vector<Z3_ast> asts;
+		for(unsigned int i=0; i<fmls.size(); i++)
+			asts.push_back(fmls[i]);
+		Z3_ast last = encoder->z3_context->bool_val(true);
+		if(!asts.empty()) {
+			last = asts.back();
+			asts.pop_back();
+		}
+		std::string smt2 = Z3_benchmark_to_smtlib_string(*encoder->z3_context, "", "", "unknown", "",
+				asts.size(), asts.empty() ? NULL : &asts[0], last);
+		writeFile(horizonFile(H, ".smt2"), smt2);
+
+		// plan steps
+		std::vector<PlanStep> steps;
+		encoder->getPlanSteps(steps);
+		std::stringstream plan;
+		plan << "linear\t" << (linear ? 1 : 0) << "\n";
+		for(unsigned int i=0; i<steps.size(); i++) {
+			plan << steps[i].h << "\t" << symbolName(steps[i].start) << "\t" << symbolName(steps[i].duration)
+				<< "\t" << symbolName(steps[i].time) << "\t" << steps[i].action << "\n";
+		}
+		writeFile(horizonFile(H, ".plan"), plan.str());
+	}
+
+	/**
+	 * The plan is written as printModel would print it, so a later run
+	 * prints it without solving.
+	 */
+	void EncodingCache::storeResult(int H, Encoder * encoder, z3::check_result result) {
+
+		if(!enabled() || result == z3::unknown) return;
+
+		std::stringstream contents;
+		if(result == z3::unsat) {
+			contents << "unsat\n";
+		} else {
+			contents << "sat\n";
+			z3::model m = encoder->z3_model ? *encoder->z3_model : encoder->z3_solver->get_model();
+			z3::expr t = encoder->z3_context->bool_val(true);
+			std::vector<PlanStep> steps;
+			encoder->getPlanSteps(steps);
+			for(unsigned int i=0; i<steps.size(); i++) {
+				z3::expr v = m.eval(steps[i].start);
+				if(eq(v,t)) contents << m.eval(steps[i].time) << ":\t" << steps[i].action << " [" << m.eval(steps[i].duration) << "]" << std::endl;
+			}
+		}
+		writeFile(horizonFile(H, ".result"), contents.str());
+	}
+
+	/*---------*/
+	/* solving */
+	/*---------*/
+
+	bool EncodingCache::readPlan(int H, bool &linear) {
+
+		std::string contents;
+		if(!readFile(horizonFile(H, ".plan"), contents)) return false;
+
+		std::stringstream in(contents);
+		std::string line, field;
+		if(!std::getline(in, line) || line.substr(0, 7) != "linear\t") return false;
+		linear = (line.substr(7) == "1");
+
+		while(std::getline(in, line)) {
+			std::stringstream ss(line);
+			std::vector<std::string> fields;
+			while(fields.size() < 4 && std::getline(ss, field, '\t'))
+				fields.push_back(field);
+			std::getline(ss, field);
+			if(fields.size() < 4) return false;
+			PlanStep step = {atoi(fields[0].c_str()), field,
+					cache_context->bool_const(fields[1].c_str()),
+					cache_context->real_const(fields[2].c_str()),
+					cache_context->real_const(fields[3].c_str())};
+			cache_steps.push_back(step);
+		}
+		return true;
+	}
+
+	/**
+	 * Each horizon is solved with a fresh solver in a single context.
+	 * A missing or unreadable horizon is reported as unknown.
+	 */
+	z3::check_result EncodingCache::solve(int H) {
+
+		cache_steps.clear();
+		cache_plan = "";
+		if(cache_solver) {
+			delete cache_solver;
+			cache_solver = NULL;
+		}
+
+		// solved before
+		std::string result;
+		if(readFile(horizonFile(H, ".result"), result)) {
+			if(result.compare(0, 6, "unsat\n") == 0) return z3::unsat;
+			if(result.compare(0, 4, "sat\n") == 0) {
+				cache_plan = result.substr(4);
+				return z3::sat;
+			}
+		}
+
+		if(!cache_context) {
+			z3::config cfg;
+			cfg.set("auto_config", true);
+			cache_context = new z3::context(cfg);
+		}
+
+		std::string smt2;
+		bool linear;
+		if(!readFile(horizonFile(H, ".smt2"), smt2) || !readPlan(H, linear))
+			return z3::unknown;
+
+		std::string strategy = opt->strategy;
+		if(strategy == "auto") strategy = linear ? "qflra" : "qfnra-nlsat";
+
+		z3::tactic tactic = mk_strategy(*cache_context, strategy);
+		cache_solver = new z3::solver(*cache_context, tactic.mk_solver());
+		try {
+			cache_solver->from_string(smt2.c_str());
+		} catch(z3::exception &e) {
+			std::cerr << "Cannot parse " << horizonFile(H, ".smt2") << std::endl;
+			return z3::unknown;
+		}
+		return cache_solver->check();
+	}
+
+	void EncodingCache::printModel() {
+		if(!cache_solver) {
+			std::cout << cache_plan;
+			return;
+		}
+		z3::model m = cache_solver->get_model();
+		z3::expr t = cache_context->bool_val(true);
+		z3::set_param("pp.decimal", true);
+		for(unsigned int i=0; i<cache_steps.size(); i++) {
+			z3::expr v = m.eval(cache_steps[i].start);
+			if(eq(v,t)) std::cout << m.eval(cache_steps[i].time) << ":\t" << cache_steps[i].action << " [" << m.eval(cache_steps[i].duration) << "]" << std::endl;
+		}
+	}
+
+} // close namespace
@@ -0,0 +1,66 @@
+#include "SMTPlan/Grounder.h"
+
+/* implementation of SMTPlan::Grounder */
+namespace SMTPlan {
+
+	void Grounder::ground() {
+
+		VAL::operator_list::const_iterator os = val_analysis->the_domain->ops->begin();
+		for(; os != val_analysis->the_domain->ops->end(); ++os)
+			schemas.push_back(*os);
+
+		unsigned int threads = opt->ground_threads;
+		if(threads > schemas.size()) threads = schemas.size();
+		if(threads <= 1) {
+			for(unsigned int i=0; i<schemas.size(); i++)
+				Inst::instantiatedOp::instantiate(schemas[i], val_analysis->the_problem, *type_checker);
+			return;
+		}
+
+		// the caches shared by all schemas are filled before the threads start
+		for(unsigned int i=0; i<schemas.size(); i++)
+			Inst::instantiatedOp::prepareInstantiate(schemas[i], *type_checker);
+		Inst::instantiatedOp::prepareEvaluate(val_analysis->the_problem->the_goal, *type_checker);
+
+		schema_ops = std::vector<Inst::OpStore>(schemas.size());
+		schema_stats = std::vector<Inst::GroundingStats>(schemas.size());
+		next_schema = 0;
+		grounding_arena = VAL::Arena::current();
+
+		boost::thread_group workers;
+		for(unsigned int w=0; w<threads; w++)
+			workers.create_thread(boost::bind(&Grounder::groundWorker, this));
+		workers.join_all();
+
+		for(unsigned int i=0; i<schemas.size(); i++)
+			Inst::instantiatedOp::mergeOps(schema_ops[i], schema_stats[i]);
+		schema_ops.clear();
+		schema_stats.clear();
+	}
+
+	/**
+	 * Schemas are handed out one at a time, as their sizes vary too
+	 * much to divide them between the workers in advance. Each worker
+	 * allocates from its own arena, handed to the grounding arena when
+	 * the worker is done.
+	 */
+	void Grounder::groundWorker() {
+		VAL::Arena arena;
+		if(grounding_arena) VAL::Arena::setCurrent(&arena);
+		while(true) {
+			unsigned int i;
+			{
+				boost::mutex::scoped_lock lock(schema_mutex);
+				if(next_schema >= schemas.size()) {
+					if(grounding_arena) grounding_arena->adopt(arena);
+					VAL::Arena::setCurrent(NULL);
+					return;
+				}
+				i = next_schema++;
+			}
+			Inst::instantiatedOp::instantiate(schemas[i], val_analysis->the_problem, *type_checker,
+					schema_ops[i], schema_stats[i]);
+		}
+	}
+
+} // close namespace
@@ -0,0 +1,253 @@
+#include "SMTPlan/HorizonSearch.h"
+
+/* implementation of SMTPlan::HorizonSearch */
+namespace SMTPlan {
+
+	/**
+	 * Creates a new encoder. Each encoder owns a z3 context, and
+	 * caches z3 expressions in its problem info, so neither can be shared.
+	 */
+	Encoder * HorizonSearch::createEncoder() {
+
+		boost::scoped_ptr<Planner::Scope> scope(planner ? new Planner::Scope(*planner) : NULL);
+		ProblemInfo * pi = new ProblemInfo(problem_info);
+		Encoder * encoder;
+		if(opt->encoder == 1)
+			encoder = new EncoderFluent(algebraist, val_analysis, *opt, *pi);
+		else
+			encoder = new EncoderHappening(algebraist, val_analysis, *opt, *pi);
+		encoder->owned_problem_info = pi;
+		return encoder;
+	}
+
+	void HorizonSearch::encodeHorizon(Encoder * encoder, int H) {
+		boost::scoped_ptr<Planner::Scope> scope(planner ? new Planner::Scope(*planner) : NULL);
+		encoder->encode(H);
+	}
+
+	bool HorizonSearch::horizonInRange(int H) {
+		if(worker_error != "") return false;
+		if(opt->upper_bound >= 0 && H > opt->upper_bound) return false;
+		if(best_horizon >= 0 && H >= best_horizon) return false;
+		return true;
+	}
+
+	/**
+	 * Run the workers and wait for them to finish.
+	 */
+	Encoder * HorizonSearch::searchParallel(int &horizon) {
+
+		worker_encoders = std::vector<Encoder *>(opt->threads, (Encoder *)NULL);
+		worker_horizons = std::vector<int>(opt->threads, -1);
+
+		boost::thread_group workers;
+		for(int w=0; w<opt->threads; w++) {
+			workers.create_thread(boost::bind(&HorizonSearch::runWorker, this, w));
+		}
+		workers.join_all();
+
+		// only the encoder holding the plan is returned
+		for(int w=0; w<opt->threads; w++) {
+			if(worker_encoders[w] != best_encoder) delete worker_encoders[w];
+		}
+		worker_encoders.clear();
+
+		if(worker_error != "") {
+			if(best_encoder) delete best_encoder;
+			best_encoder = NULL;
+			throw z3::exception(worker_error.c_str());
+		}
+
+		horizon = best_horizon;
+		return best_encoder;
+	}
+
+	/**
+	 * A single worker. Horizons are handed out in increasing order, so
+	 * each worker deepens its own encoder incrementally. A worker stops
+	 * once every horizon it could still be handed is longer than a plan
+	 * that has already been found.
+	 */
+	void HorizonSearch::runWorker(int worker) {
+
+		Encoder * encoder;
+		{
+			boost::mutex::scoped_lock lock(encode_mutex);
+			encoder = createEncoder();
+		}
+		{
+			boost::mutex::scoped_lock lock(search_mutex);
+			worker_encoders[worker] = encoder;
+		}
+
+		while(true) {
+
+			// fetch the next horizon
+			int H;
+			{
+				boost::mutex::scoped_lock lock(search_mutex);
+				if(!horizonInRange(next_horizon)) break;
+				H = next_horizon;
+				next_horizon += opt->step_size;
+				worker_horizons[worker] = H;
+			}
+
+			// generate encoding
+			boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+			{
+				boost::mutex::scoped_lock lock(encode_mutex);
+				encodeHorizon(encoder, H);
+			}
+			if(cache) cache->store(H, encoder, algebraist->linear);
+
+			// a shorter plan may have been found while encoding
+			{
+				boost::mutex::scoped_lock lock(search_mutex);
+				if(!horizonInRange(H) || encoder->wasInterrupted()) {
+					worker_horizons[worker] = -1;
+					break;
+				}
+			}
+
+			// solve
+			z3::check_result result = z3::unknown;
+			std::string error;
+			try {
+				result = encoder->solve();
+			} catch(z3::exception &e) {
+				if(!encoder->wasInterrupted()) error = e.msg();
+			}
+
+			if(cache && error == "") cache->storeResult(H, encoder, result);
+
+			boost::mutex::scoped_lock lock(search_mutex);
+			worker_horizons[worker] = -1;
+
+			// stop every worker and report the error after they finish
+			if(error != "") {
+				if(worker_error == "") worker_error = error;
+				for(int w=0; w<opt->threads; w++) {
+					if(w != worker && worker_encoders[w])
+						worker_encoders[w]->interrupt();
+				}
+				break;
+			}
+
+			bool cancelled = (result == z3::unknown && encoder->wasInterrupted());
+			if(result == z3::unknown && !cancelled) undecided++;
+
+			if(opt->verbose) {
+				boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::local_time() - start;
+				fprintf(stdout, "Solved %i:\t%f seconds (worker %i, %s)\n", H, elapsed.total_microseconds() / 1000000.0, worker,
+						(result == z3::sat ? "sat" : (result == z3::unsat ? "unsat" : (cancelled ? "cancelled" : "unknown"))));
+			}
+
+			if(result == z3::sat && (best_horizon < 0 || H < best_horizon)) {
+
+				best_horizon = H;
+				best_encoder = encoder;
+
+				// cancel the workers solving longer horizons
+				for(int w=0; w<opt->threads; w++) {
+					if(w != worker && worker_horizons[w] > H && worker_encoders[w])
+						worker_encoders[w]->interrupt();
+				}
+			}
+			if(result == z3::sat) break;
+		}
+	}
+
+	/*--------------------*/
+	/* exponential search */
+	/*--------------------*/
+
+	z3::check_result HorizonSearch::solveHorizon(Encoder * encoder, int H) {
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+		encodeHorizon(encoder, H);
+		if(cache) cache->store(H, encoder, algebraist->linear);
+		z3::check_result result = encoder->solve();
+		if(result == z3::unknown) undecided++;
+		if(cache) cache->storeResult(H, encoder, result);
+
+		if(opt->verbose) {
+			boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::local_time() - start;
+			fprintf(stdout, "Solved %i:\t%f seconds (%s)\n", H, elapsed.total_microseconds() / 1000000.0,
+					(result == z3::sat ? "sat" : (result == z3::unsat ? "unsat" : "unknown")));
+		}
+		return result;
+	}
+
+	/**
+	 * Probing upwards extends a single encoder. The bisection relies on
+	 * the encoding being monotonic: if there is a plan with H happenings,
+	 * there is one with H+1. So only an unsatisfiable horizon proves the
+	 * horizons below it unsatisfiable; an unknown one proves nothing.
+	 * Encodings cannot shrink, so a probe below the last one needs a
+	 * fresh encoder.
+	 */
+	Encoder * HorizonSearch::searchExponential(int &horizon) {
+
+		unsat_horizon = opt->lower_bound - 1;
+		Encoder * encoder = NULL;
+		Encoder * probe = NULL;
+		try {
+
+			// probe upwards
+			int H = opt->lower_bound;
+			encoder = createEncoder();
+			z3::check_result result;
+			while((result = solveHorizon(encoder, H)) != z3::sat) {
+				if(result == z3::unsat) unsat_horizon = H;
+				if(opt->upper_bound >= 0 && H >= opt->upper_bound) {
+					delete encoder;
+					horizon = -1;
+					return NULL;
+				}
+				H = (2*H > H+1) ? 2*H : H+1;
+				if(opt->upper_bound >= 0 && H > opt->upper_bound)
+					H = opt->upper_bound;
+			}
+			best_horizon = H;
+			best_encoder = encoder;
+			encoder = NULL;
+
+			// bisect downwards, until a horizon is unknown
+			int probe_horizon = 0;
+			while(opt->minimal && best_horizon - unsat_horizon > 1) {
+
+				int mid = unsat_horizon + (best_horizon - unsat_horizon) / 2;
+				if(!probe || probe_horizon > mid) {
+					if(probe) delete probe;
+					probe = NULL;
+					probe = createEncoder();
+				}
+				probe_horizon = mid;
+
+				result = solveHorizon(probe, mid);
+				if(result == z3::sat) {
+					delete best_encoder;
+					best_horizon = mid;
+					best_encoder = probe;
+					probe = NULL;
+				} else if(result == z3::unsat) {
+					unsat_horizon = mid;
+				} else {
+					break;
+				}
+			}
+			if(probe) delete probe;
+
+		} catch(z3::exception &e) {
+			if(encoder) delete encoder;
+			if(probe) delete probe;
+			if(best_encoder) delete best_encoder;
+			best_encoder = NULL;
+			throw;
+		}
+
+		horizon = best_horizon;
+		return best_encoder;
+	}
+
+} // close namespace
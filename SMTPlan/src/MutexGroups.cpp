@@ -0,0 +1,125 @@
+#include "SMTPlan/MutexGroups.h"
+
+/* implementation of SMTPlan::MutexGroups */
+namespace SMTPlan {
+
+	/**
+	 * TIM may split a predicate by the types of its arguments. Such
+	 * predicates are skipped, so that every literal of a predicate
+	 * has the same properties.
+	 */
+	bool MutexGroups::singleSignature(VAL::holding_pred_symbol * hps) {
+		int signatures = 0;
+		for(VAL::holding_pred_symbol::PIt i = hps->pBegin(); i != hps->pEnd(); ++i)
+			signatures++;
+		return signatures == 1;
+	}
+
+	void MutexGroups::find() {
+
+		// timed initial literals change the state outside the operators TIM analysed
+		if(!val_analysis->the_problem->initial_state->timed_effects.empty())
+			return;
+
+		/*
+		 * TIM does not visit events, so their effects are not checked
+		 * against the invariants. The names of durative actions are
+		 * also those of the predicates TIM adds to mark them running.
+		 */
+		std::set<std::string> running;
+		VAL::operator_list * ops = val_analysis->the_domain->ops;
+		for(VAL::operator_list::const_iterator o = ops->begin(); o != ops->end(); ++o) {
+			if(dynamic_cast<VAL::event *>(*o)) return;
+			if(dynamic_cast<VAL::durative_action *>(*o))
+				running.insert((*o)->name->getName());
+		}
+
+		// spaces usable as groups, and the spaces of each predicate position
+		std::vector<std::set<VAL::const_symbol *> > space_objects;
+		std::vector<bool> space_exact;
+		std::map<std::pair<VAL::holding_pred_symbol *, int>, std::vector<int> > property_spaces;
+
+		for(TIM::TIMAnalyser::const_iterator s = TIM::TA->pbegin(); s != TIM::TA->pend(); ++s) {
+			TIM::PropertySpace * ps = *s;
+			if(ps->isStatic()) continue;
+
+			bool single = true;
+			bool exact = true;
+			for(TIM::PropertySpace::SIterator st = ps->begin(); st != ps->end(); ++st) {
+				if((*st)->size() > 1) single = false;
+				if((*st)->empty()) exact = false;
+			}
+			for(TIM::PropertySpace::PIterator p = ps->pbegin(); single && p != ps->pend(); ++p) {
+				if(!singleSignature((*p)->root()->getParent())) single = false;
+				// an object may be held by a running action instead of a literal
+				if(running.count((*p)->root()->getParent()->getName())) exact = false;
+			}
+			if(!single) continue;
+
+			int id = space_objects.size();
+			space_objects.push_back(std::set<VAL::const_symbol *>(ps->obegin(), ps->oend()));
+			space_exact.push_back(exact);
+			for(TIM::PropertySpace::PIterator p = ps->pbegin(); p != ps->pend(); ++p)
+				property_spaces[std::make_pair((*p)->root()->getParent(), (*p)->aPosn())].push_back(id);
+		}
+		if(space_objects.empty()) return;
+
+		// literals of each space and object
+		std::map<std::pair<int, VAL::const_symbol *>, std::vector<int> > groups;
+		std::set<std::pair<int, VAL::const_symbol *> > partial;
+
+		Inst::LiteralStore::iterator litItr = Inst::instantiatedOp::literalsBegin();
+		const Inst::LiteralStore::iterator litEnd = Inst::instantiatedOp::literalsEnd();
+		for (; litItr != litEnd; ++litItr) {
+			Inst::Literal * const currLit = *litItr;
+			bool isStatic = problem_info->staticPredicateMap[currLit->getHead()->getName()];
+			VAL::holding_pred_symbol * hps = HPS(currLit->getHead());
+
+			int posn = 0;
+			for(VAL::LiteralParameterIterator<VAL::parameter_symbol_list::iterator> a = currLit->begin(); a != currLit->end(); ++a, ++posn) {
+				std::map<std::pair<VAL::holding_pred_symbol *, int>, std::vector<int> >::iterator spaces = property_spaces.find(std::make_pair(hps, posn));
+				if(spaces == property_spaces.end()) continue;
+				VAL::const_symbol * object = static_cast<VAL::const_symbol *>(*a);
+				for(unsigned int i=0; i<spaces->second.size(); i++) {
+					if(!space_objects[spaces->second[i]].count(object)) continue;
+					std::pair<int, VAL::const_symbol *> key(spaces->second[i], object);
+					// static literals are not encoded as variables
+					if(isStatic) {
+						partial.insert(key);
+						continue;
+					}
+					std::vector<int> &lits = groups[key];
+					if(lits.empty() || lits.back() != currLit->getID())
+						lits.push_back(currLit->getID());
+				}
+			}
+		}
+
+		// literals true in the initial state
+		std::set<int> initial;
+		VAL::FastEnvironment env(0);
+		VAL::effect_lists * init = val_analysis->the_problem->initial_state;
+		for(VAL::pc_list<VAL::simple_effect*>::const_iterator ci = init->add_effects.begin(); ci != init->add_effects.end(); ci++) {
+			Inst::Literal l((*ci)->prop, &env);
+			Inst::Literal * const lit = Inst::instantiatedOp::findLiteral(&l);
+			if(lit) initial.insert(lit->getID());
+		}
+
+		std::map<std::pair<int, VAL::const_symbol *>, std::vector<int> >::iterator g = groups.begin();
+		for(; g != groups.end(); ++g) {
+			if(g->second.size() < 2) continue;
+
+			int holding = 0;
+			for(unsigned int i=0; i<g->second.size(); i++)
+				holding += initial.count(g->second[i]);
+			if(holding > 1) continue;
+
+			MutexGroup group;
+			group.literals = g->second;
+			group.exactlyOne = space_exact[g->first.first] && !partial.count(g->first) && holding == 1;
+			problem_info->mutexGroups.push_back(group);
+			grouped_literals += group.literals.size();
+		}
+	}
+
+} // close namespace
@@ -0,0 +1,237 @@
+#include "SMTPlan/PlanServer.h"
+
+/* implementation of SMTPlan::PlanServer */
+namespace SMTPlan {
+
+	void PlanServer::start(std::ostream &out) {
+		output = &out;
+		input_closed = false;
+		z3::set_param("pp.decimal", true);
+		for(int w=0; w<workers; w++)
+			pool.create_thread(boost::bind(&PlanServer::runWorker, this));
+	}
+
+	void PlanServer::submit(const std::vector<std::string> &args) {
+		Job job;
+		job.id = next_id++;
+		job.args = args;
+		boost::mutex::scoped_lock lock(job_mutex);
+		jobs.push_back(job);
+		job_ready.notify_one();
+	}
+
+	/**
+	 * The workers keep running until every queued request is answered.
+	 */
+	void PlanServer::finish() {
+		{
+			boost::mutex::scoped_lock lock(job_mutex);
+			input_closed = true;
+			job_ready.notify_all();
+		}
+		pool.join_all();
+	}
+
+	void PlanServer::serve(std::istream &in, std::ostream &out) {
+		start(out);
+		std::string line;
+		while(std::getline(in, line)) {
+			std::vector<std::string> args;
+			std::stringstream ss(line);
+			std::string arg;
+			while(ss >> arg) args.push_back(arg);
+			if(!args.empty()) submit(args);
+		}
+		finish();
+	}
+
+	void PlanServer::batch(const std::string &domain, const std::vector<std::string> &problems, std::ostream &out) {
+		start(out);
+		for(unsigned int i=0; i<problems.size(); i++) {
+			std::vector<std::string> args;
+			args.push_back(domain);
+			args.push_back(problems[i]);
+			submit(args);
+		}
+		finish();
+	}
+
+	void PlanServer::runWorker() {
+		while(true) {
+			Job job;
+			{
+				boost::mutex::scoped_lock lock(job_mutex);
+				while(jobs.empty() && !input_closed) job_ready.wait(lock);
+				if(jobs.empty()) return;
+				job = jobs.front();
+				jobs.pop_front();
+			}
+			std::stringstream answer;
+			try {
+				runJob(job, answer);
+			} catch(z3::exception &e) {
+				answer.str("");
+				answer << "job " << job.id << " error: " << e.msg() << std::endl;
+			}
+			boost::mutex::scoped_lock lock(output_mutex);
+			*output << answer.str() << std::flush;
+		}
+	}
+
+	/**
+	 * Plans a single request with the encoder's own model, as printModel
+	 * writes to the standard output shared by all workers.
+	 */
+	void PlanServer::runJob(const Job &job, std::ostream &out) {
+
+		boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+
+		// the request as a command line
+		std::vector<std::string> args;
+		args.push_back("SMTPlan");
+		args.insert(args.end(), job.args.begin(), job.args.begin() + std::min((size_t)2, job.args.size()));
+		args.insert(args.end(), server_args.begin(), server_args.end());
+		if(job.args.size() > 2) args.insert(args.end(), job.args.begin() + 2, job.args.end());
+
+		std::vector<char *> argv;
+		for(unsigned int i=0; i<args.size(); i++)
+			argv.push_back(const_cast<char *>(args[i].c_str()));
+
+		PlannerOptions options;
+		if(job.args.size() < 2 || !parse_arguments(argv.size(), &argv[0], options)) {
+			out << "job " << job.id << " error: expected domain problem [options]" << std::endl;
+			return;
+		}
+		options.verbose = false;
+		options.debug = false;
+		if(options.upper_bound < 0) options.upper_bound = horizon_cap;
+
+		// VAL exits on a file it cannot open, so check first
+		if(!std::ifstream(options.domain_path.c_str()).good() || !std::ifstream(options.problem_path.c_str()).good()) {
+			out << "job " << job.id << " error: cannot read domain or problem file" << std::endl;
+			return;
+		}
+		if(!parses(options)) {
+			out << "job " << job.id << " error: cannot parse or type check domain or problem" << std::endl;
+			return;
+		}
+
+		Planner planner(options);
+		planner.ground();
+		if(!planner.processDomain()) {
+			out << "job " << job.id << " error: cyclic continuous effects" << std::endl;
+			return;
+		}
+
+		std::string logic = planner.algebraist->linear ? "qflra" : "qfnra-nlsat";
+		if(options.strategy == "auto") options.strategy = logic;
+		std::replace(options.portfolio.begin(), options.portfolio.end(), std::string("auto"), logic);
+
+		Encoder * encoder = NULL;
+		int horizon = -1;
+		int undecided = 0;
+		int unsat_horizon = options.lower_bound - 1;
+
+		if(options.threads > 1 || options.exponential) {
+			VAL::analysis * analysis;
+			{
+				Planner::Scope scope(planner);
+				analysis = VAL::current_analysis;
+			}
+			HorizonSearch search(planner.algebraist, analysis, options, planner.problem_info, &planner);
+			encoder = options.exponential ? search.searchExponential(horizon) : search.searchParallel(horizon);
+			undecided = search.undecided;
+			unsat_horizon = search.unsat_horizon;
+		} else {
+			{
+				Planner::Scope scope(planner);
+				encoder = planner.createEncoder();
+			}
+			if(!encoder) {
+				out << "job " << job.id << " error: unknown encoding" << std::endl;
+				return;
+			}
+			for(int H = options.lower_bound; options.upper_bound < 0 || H <= options.upper_bound; H += options.step_size) {
+				{
+					Planner::Scope scope(planner);
+					encoder->encode(H);
+				}
+				z3::check_result result = encoder->solve();
+				if(result == z3::sat) {
+					horizon = H;
+					break;
+				}
+				if(result == z3::unknown) undecided++;
+			}
+		}
+
+		boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::local_time() - start;
+		if(horizon < 0) {
+			out << "job " << job.id << " unsolved in " << options.upper_bound << " happenings";
+			if(undecided > 0) out << ", " << undecided << " unknown,";
+			out << " in " << elapsed.total_microseconds() / 1000000.0 << " seconds" << std::endl;
+		} else {
+			out << "job " << job.id << " plan" << std::endl;
+			writePlan(encoder, out);
+			out << "job " << job.id << " solved " << horizon << " happenings in "
+				<< elapsed.total_microseconds() / 1000000.0 << " seconds" << std::endl;
+			if(options.exponential && options.minimal && horizon - unsat_horizon > 1)
+				out << "job " << job.id << " horizons " << unsat_horizon + 1 << " to " << horizon - 1 << " unknown" << std::endl;
+		}
+		if(encoder) delete encoder;
+	}
+
+	/**
+	 * VAL exits the process on a malformed domain or problem, so each
+	 * request is first parsed and type checked in a child process. The
+	 * child reports success through a pipe, as VAL also exits with 0.
+	 * The fork is made in the scope of an empty planner, so the child
+	 * starts from clean VAL state and no other thread is changing it.
+	 */
+	bool PlanServer::parses(const PlannerOptions &options) {
+
+		int fds[2];
+		if(pipe(fds) != 0) return true;
+
+		pid_t pid;
+		{
+			PlannerOptions probe_options = options;
+			Planner probe(probe_options);
+			Planner::Scope scope(probe);
+			pid = fork();
+			if(pid == 0) {
+				// VAL writes some of its messages to the standard output
+				close(fds[0]);
+				dup2(2, 1);
+				char * files[2] = {const_cast<char *>(options.domain_path.c_str()), const_cast<char *>(options.problem_path.c_str())};
+				TIM::performTIMAnalysis(files);
+				char ok = 1;
+				if(write(fds[1], &ok, 1) != 1) _exit(1);
+				_exit(0);
+			}
+		}
+		close(fds[1]);
+		if(pid < 0) {
+			close(fds[0]);
+			return true;
+		}
+
+		char ok = 0;
+		bool parsed = (read(fds[0], &ok, 1) == 1 && ok == 1);
+		close(fds[0]);
+		waitpid(pid, NULL, 0);
+		return parsed;
+	}
+
+	void PlanServer::writePlan(Encoder * encoder, std::ostream &out) {
+		z3::model m = encoder->z3_model ? *encoder->z3_model : encoder->z3_solver->get_model();
+		z3::expr t = encoder->z3_context->bool_val(true);
+		std::vector<PlanStep> steps;
+		encoder->getPlanSteps(steps);
+		for(unsigned int i=0; i<steps.size(); i++) {
+			z3::expr v = m.eval(steps[i].start);
+			if(eq(v,t)) out << m.eval(steps[i].time) << ":\t" << steps[i].action << " [" << m.eval(steps[i].duration) << "]" << std::endl;
+		}
+	}
+
+} // close namespace
@@ -0,0 +1,113 @@
+#include "SMTPlan/Planner.h"
+
+/* implementation of SMTPlan::Planner */
+namespace SMTPlan {
+
+	boost::mutex Planner::val_mutex;
+
+	/**
+	 * The problem is parsed and grounded with the planner's arena current,
+	 * so releasing the arena frees the parse tree and the grounded
+	 * instances at once, without running their destructors. Encoders are
+	 * not in the arena; each frees its own z3 state when it is deleted.
+	 */
+	Planner::~Planner() {
+		if(algebraist) delete algebraist;
+		inst_state.clear();
+	}
+
+	void Planner::swapState() {
+		std::swap(VAL::current_analysis, val_analysis);
+		std::swap(VAL::theTC, val_type_checker);
+		std::swap(TIM::TA, tim_analyser);
+		inst_state.swap();
+	}
+
+	void Planner::ground() {
+
+		Scope scope(*this);
+
+		// parse domain and problem
+		char * files[2] = {const_cast<char *>(opt->domain_path.c_str()), const_cast<char *>(opt->problem_path.c_str())};
+		TIM::performTIMAnalysis(files);
+		Inst::SimpleEvaluator::setInitialState();
+		Grounder grounder(VAL::current_analysis, *VAL::theTC, *opt);
+		grounder.ground();
+		Inst::instantiatedOp::createAllLiterals(VAL::current_analysis->the_problem, VAL::theTC);
+		Inst::instantiatedOp::filterOps(VAL::theTC);
+		grounding_stats = Inst::instantiatedOp::groundingStats;
+		grounded_ops = Inst::instantiatedOp::howMany();
+
+		// save static predicates
+		if(VAL::current_analysis->the_domain->predicates) {
+			VAL::pred_decl_list * predicates = VAL::current_analysis->the_domain->predicates;
+			for(VAL::pred_decl_list::const_iterator ci = predicates->begin(); ci != predicates->end(); ci++) {
+				VAL::holding_pred_symbol * hps = HPS((*ci)->getPred());
+				bool isStatic = true;
+				for(VAL::holding_pred_symbol::PIt i = hps->pBegin(); i != hps->pEnd(); ++i) {
+					TIM::TIMpredSymbol * tps = const_cast<TIM::TIMpredSymbol *>(static_cast<const TIM::TIMpredSymbol *>(*i));
+					if(!tps->isDefinitelyStatic() || !tps->isStatic()) {
+						isStatic = false;
+						break;
+					}
+				}
+				problem_info.staticPredicateMap[hps->getName()] = isStatic;
+			}
+		}
+
+		// save static functions
+		if(VAL::current_analysis->the_domain->functions) {
+			VAL::func_decl_list * functions = VAL::current_analysis->the_domain->functions;
+			for(VAL::func_decl_list::const_iterator ci = functions->begin(); ci != functions->end(); ci++) {
+				VAL::extended_func_symbol * efs = static_cast<VAL::extended_func_symbol *>(const_cast<VAL::func_symbol *>((*ci)->getFunction()));
+				problem_info.staticFunctionMap[efs->getName()] = efs->isStatic();
+			}
+		}
+
+		// remove operators that can never be applied
+		if(opt->reachability) {
+			Reachability reachability(VAL::current_analysis, *opt, problem_info);
+			reachability.prune();
+			pruned_ops = reachability.pruned_ops;
+			pruned_literals = reachability.pruned_literals;
+		}
+
+		// literals of which at most one can hold at once
+		if(opt->mutex_groups || opt->finite_domain) {
+			MutexGroups groups(VAL::current_analysis, *opt, problem_info);
+			groups.find();
+			grouped_literals = groups.grouped_literals;
+		}
+
+		// objects that can be swapped without changing the problem
+		if(opt->symmetry) {
+			Symmetries symmetries(VAL::current_analysis, *opt, problem_info);
+			symmetries.find();
+			symmetric_objects = symmetries.symmetric_objects;
+		}
+	}
+
+	bool Planner::processDomain() {
+		Scope scope(*this);
+		algebraist = new Algebraist(VAL::current_analysis, *opt, problem_info);
+		return algebraist->processDomain();
+	}
+
+	/**
+	 * The encoder caches z3 expressions in its problem info, which must
+	 * be freed with its context, so it is given its own copy.
+	 */
+	Encoder * Planner::createEncoder() {
+		if(opt->encoder != 0 && opt->encoder != 1)
+			return NULL;
+		ProblemInfo * pi = new ProblemInfo(problem_info);
+		Encoder * encoder;
+		if(opt->encoder == 1)
+			encoder = new EncoderFluent(algebraist, VAL::current_analysis, *opt, *pi);
+		else
+			encoder = new EncoderHappening(algebraist, VAL::current_analysis, *opt, *pi);
+		encoder->owned_problem_info = pi;
+		return encoder;
+	}
+
+} // close namespace
@@ -0,0 +1,466 @@
+#include "SMTPlan/Reachability.h"
+
+/* implementation of SMTPlan::Reachability */
+namespace SMTPlan {
+
+	Interval Reachability::unbounded() {
+		Interval i = {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+		return i;
+	}
+
+	/* product of two bounds, where zero times infinity is zero */
+	double Reachability::product(double a, double b) {
+		if(a == 0 || b == 0) return 0;
+		return a * b;
+	}
+
+	/* a literal missing from the store has no ID to mark, and its conditions are relaxed */
+	void Reachability::addLiteral(VAL::proposition * prop) {
+		Inst::Literal * l = new Inst::Literal(prop, fe);
+		Inst::Literal * const lit = Inst::instantiatedOp::findLiteral(l);
+		if(lit && !reachable_literals[lit->getID()]) {
+			reachable_literals[lit->getID()] = true;
+			literal_levels[lit->getID()] = reach_level;
+			reach_changed = true;
+		}
+		delete l;
+	}
+
+	/**
+	 * A bound that moves is widened to infinity at once, so each bound
+	 * changes at most once and the fixed point is reached quickly.
+	 */
+	void Reachability::widen(int pneID, const Interval &values) {
+		Interval &bounds = function_bounds[pneID];
+		if(values.lower < bounds.lower) {
+			bounds.lower = -std::numeric_limits<double>::infinity();
+			reach_changed = true;
+		}
+		if(values.upper > bounds.upper) {
+			bounds.upper = std::numeric_limits<double>::infinity();
+			reach_changed = true;
+		}
+	}
+
+	/**
+	 * Within a happening there are cascade_bound - 1 steps of events, the
+	 * last shared with actions, and one more step of continuous change up
+	 * to the next happening. A literal of layer k can then only hold at
+	 * happening h if k <= (h+1) * cascade_bound.
+	 */
+	int Reachability::happening(int level) {
+		int steps = opt->cascade_bound < 1 ? 1 : opt->cascade_bound;
+		int h = (level + steps - 1) / steps - 1;
+		return h < 0 ? 0 : h;
+	}
+
+	/**
+	 * Main processing method
+	 */
+	void Reachability::prune() {
+
+		reachable_ops = std::vector<bool>(Inst::instantiatedOp::howMany(), false);
+		reachable_literals = std::vector<bool>(Inst::instantiatedOp::howManyLiterals(), false);
+		function_bounds = std::vector<Interval>(Inst::instantiatedOp::howManyPNEs(), unbounded());
+		op_levels = std::vector<int>(reachable_ops.size(), -1);
+		literal_levels = std::vector<int>(reachable_literals.size(), -1);
+		reach_level = 0;
+
+		// initial state, and timed initial literals as if they had happened
+		VAL::effect_lists* eff_list = val_analysis->the_problem->initial_state;
+		for (VAL::pc_list<VAL::simple_effect*>::const_iterator ci = eff_list->add_effects.begin(); ci != eff_list->add_effects.end(); ci++) {
+			addLiteral((*ci)->prop);
+		}
+		for (VAL::pc_list<VAL::timed_effect*>::const_iterator ci = eff_list->timed_effects.begin(); ci != eff_list->timed_effects.end(); ci++) {
+			VAL::pc_list<VAL::simple_effect*> &adds = (*ci)->effs->add_effects;
+			for (VAL::pc_list<VAL::simple_effect*>::const_iterator ai = adds.begin(); ai != adds.end(); ai++)
+				addLiteral((*ai)->prop);
+		}
+		for (VAL::pc_list<VAL::assignment*>::const_iterator ci = eff_list->assign_effects.begin(); ci != eff_list->assign_effects.end(); ci++) {
+			const VAL::assignment* effect = *ci;
+			Inst::PNE * l = new Inst::PNE(effect->getFTerm(), fe);
+			Inst::PNE * const lit = Inst::instantiatedOp::findPNE(l);
+			effect->getExpr()->visit(this);
+			if(lit) function_bounds[lit->getID()] = reach_expression_stack.back();
+			reach_expression_stack.pop_back();
+			delete l;
+		}
+
+		// relaxed planning graph, a layer at a time
+		Inst::OpStore::iterator opsItr;
+		const Inst::OpStore::iterator opsEnd = Inst::instantiatedOp::opsEnd();
+		int level = 0;
+		reach_changed = true;
+		while(reach_changed) {
+
+			// operators whose conditions hold in this layer
+			reach_changed = false;
+			reach_state = REACH_CONDITION;
+			for (opsItr = Inst::instantiatedOp::opsBegin(); opsItr != opsEnd; ++opsItr) {
+				Inst::instantiatedOp * const currOp = *opsItr;
+				if(reachable_ops[currOp->getID()]) continue;
+				fe = currOp->getEnv();
+				reach_satisfied = true;
+				reach_at_start = true;
+				currOp->forOp()->visit(this);
+				if(!reach_satisfied) continue;
+				reachable_ops[currOp->getID()] = true;
+				op_levels[currOp->getID()] = level;
+				reach_changed = true;
+			}
+
+			// effects make the next layer, applied again as the functions they use widen
+			reach_state = REACH_EFFECT;
+			reach_level = level + 1;
+			for (opsItr = Inst::instantiatedOp::opsBegin(); opsItr != opsEnd; ++opsItr) {
+				Inst::instantiatedOp * const currOp = *opsItr;
+				if(!reachable_ops[currOp->getID()]) continue;
+				fe = currOp->getEnv();
+				currOp->forOp()->visit(this);
+			}
+			level++;
+		}
+		reach_state = REACH_NONE;
+
+		// first happenings, by the IDs the operators will have once filtered
+		if(opt->layered) {
+			for(unsigned int i=0; i<op_levels.size(); i++) {
+				if(reachable_ops[i]) problem_info->operatorHappenings.push_back(happening(op_levels[i]));
+			}
+			for(unsigned int i=0; i<literal_levels.size(); i++) {
+				problem_info->literalHappenings.push_back(reachable_literals[i] ? happening(literal_levels[i]) : 0);
+			}
+		}
+
+		// remove the operators, and mark the literals
+		pruned_ops = std::count(reachable_ops.begin(), reachable_ops.end(), false);
+		if(pruned_ops > 0) Inst::instantiatedOp::filterOps(reachable_ops);
+
+		pruned_literals = 0;
+		for(unsigned int i=0; i<reachable_literals.size(); i++) {
+			if(reachable_literals[i]) continue;
+			problem_info->unreachableLiterals.insert(i);
+			pruned_literals++;
+		}
+	}
+
+	/*-------------------------*/
+	/* operators and processes */
+	/*-------------------------*/
+
+	void Reachability::visit_action(VAL::action * o) {
+		if(reach_state == REACH_CONDITION) {
+			if(o->precondition) o->precondition->visit(this);
+		} else {
+			o->effects->visit(this);
+		}
+	}
+
+	/**
+	 * Invariant and end conditions may be achieved by the action's own
+	 * start effects, so these are collected before the conditions are checked.
+	 */
+	void Reachability::visit_durative_action(VAL::durative_action * da) {
+		if(reach_state == REACH_CONDITION) {
+			reach_start_adds.clear();
+			reach_state = REACH_START_EFFECT;
+			da->effects->visit(this);
+			reach_state = REACH_CONDITION;
+			if(da->precondition) da->precondition->visit(this);
+		} else {
+			da->effects->visit(this);
+		}
+	}
+
+	void Reachability::visit_event(VAL::event * e) {
+		if(reach_state == REACH_CONDITION) {
+			if(e->precondition) e->precondition->visit(this);
+		} else {
+			e->effects->visit(this);
+		}
+	}
+
+	void Reachability::visit_process(VAL::process * p) {
+		if(reach_state == REACH_CONDITION) {
+			if(p->precondition) p->precondition->visit(this);
+		} else {
+			p->effects->visit(this);
+		}
+	}
+
+	/*------------*/
+	/* conditions */
+	/*------------*/
+
+	/*
+	 * Negative, quantified and implied conditions are not visited,
+	 * so they are always relaxed to true.
+	 */
+
+	void Reachability::visit_simple_goal(VAL::simple_goal * c) {
+
+		if(reach_state != REACH_CONDITION) return;
+
+		Inst::Literal * l = new Inst::Literal(c->getProp(), fe);
+		Inst::Literal * const lit = Inst::instantiatedOp::findLiteral(l);
+		delete l;
+
+		// equality and derived literals are not in the store, so are not known to be false
+		if(!lit) return;
+		if(reachable_literals[lit->getID()]) return;
+		if(!reach_at_start && reach_start_adds.find(lit->getID()) != reach_start_adds.end()) return;
+		reach_satisfied = false;
+	}
+
+	void Reachability::visit_conj_goal(VAL::conj_goal * c) {
+		c->getGoals()->visit(this);
+	}
+
+	void Reachability::visit_disj_goal(VAL::disj_goal * c) {
+
+		bool satisfied = reach_satisfied;
+		bool any = false;
+		VAL::goal_list::const_iterator git = c->getGoals()->begin();
+		for(; git != c->getGoals()->end(); git++) {
+			reach_satisfied = true;
+			(*git)->visit(this);
+			any = any || reach_satisfied;
+		}
+		reach_satisfied = satisfied && any;
+	}
+
+	void Reachability::visit_timed_goal(VAL::timed_goal * c) {
+		bool at_start = reach_at_start;
+		reach_at_start = (c->getTime() == VAL::E_AT_START);
+		c->getGoal()->visit(this);
+		reach_at_start = at_start;
+	}
+
+	/**
+	 * Numeric invariant and end conditions may depend on the action's own
+	 * start effects, so only start conditions are checked.
+	 */
+	void Reachability::visit_comparison(VAL::comparison * c) {
+
+		if(reach_state != REACH_CONDITION || !reach_at_start) return;
+
+		c->getLHS()->visit(this);
+		c->getRHS()->visit(this);
+
+		Interval rhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+		Interval lhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+
+		// interval of lhs - rhs, strict comparisons are relaxed
+		double lower = lhs.lower - rhs.upper;
+		double upper = lhs.upper - rhs.lower;
+
+		switch(c->getOp()) {
+		case VAL::E_GREATER:
+		case VAL::E_GREATEQ:
+			if(upper < 0) reach_satisfied = false;
+			break;
+		case VAL::E_LESS:
+		case VAL::E_LESSEQ:
+			if(lower > 0) reach_satisfied = false;
+			break;
+		case VAL::E_EQUALS:
+			if(lower > 0 || upper < 0) reach_satisfied = false;
+			break;
+		}
+	}
+
+	/*---------*/
+	/* effects */
+	/*---------*/
+
+	/*
+	 * Delete effects are ignored. Universally quantified effects are not
+	 * encoded, so they are ignored here too.
+	 */
+	void Reachability::visit_effect_lists(VAL::effect_lists * e) {
+		e->add_effects.pc_list<VAL::simple_effect*>::visit(this);
+		e->cond_effects.pc_list<VAL::cond_effect*>::visit(this);
+		e->cond_assign_effects.pc_list<VAL::cond_effect*>::visit(this);
+		e->assign_effects.pc_list<VAL::assignment*>::visit(this);
+		e->timed_effects.pc_list<VAL::timed_effect*>::visit(this);
+	}
+
+	void Reachability::visit_simple_effect(VAL::simple_effect * e) {
+
+		if(reach_state == REACH_EFFECT) {
+			addLiteral(e->prop);
+			return;
+		}
+
+		if(reach_state == REACH_START_EFFECT) {
+			Inst::Literal * l = new Inst::Literal(e->prop, fe);
+			Inst::Literal * const lit = Inst::instantiatedOp::findLiteral(l);
+			if(lit) reach_start_adds.insert(lit->getID());
+			delete l;
+		}
+	}
+
+	/* the condition of a conditional effect is relaxed to true */
+	void Reachability::visit_cond_effect(VAL::cond_effect * e) {
+		e->getEffects()->visit(this);
+	}
+
+	void Reachability::visit_timed_effect(VAL::timed_effect * e) {
+		if(reach_state == REACH_START_EFFECT && e->ts != VAL::E_AT_START) return;
+		reach_eff_time = e->ts;
+		e->effs->visit(this);
+	}
+
+	void Reachability::visit_assignment(VAL::assignment * e) {
+
+		if(reach_state != REACH_EFFECT) return;
+
+		Inst::PNE * l = new Inst::PNE(e->getFTerm(), fe);
+		Inst::PNE * const lit = Inst::instantiatedOp::findPNE(l);
+		delete l;
+
+		if(!lit) return;
+
+		e->getExpr()->visit(this);
+		Interval value = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+
+		Interval change = unbounded();
+		switch(e->getOp()) {
+		case VAL::E_ASSIGN:
+			widen(lit->getID(), value);
+			break;
+		case VAL::E_INCREASE:
+			change.lower = (value.lower < 0) ? change.lower : function_bounds[lit->getID()].lower;
+			change.upper = (value.upper > 0) ? change.upper : function_bounds[lit->getID()].upper;
+			widen(lit->getID(), change);
+			break;
+		case VAL::E_DECREASE:
+			change.lower = (value.upper > 0) ? change.lower : function_bounds[lit->getID()].lower;
+			change.upper = (value.lower < 0) ? change.upper : function_bounds[lit->getID()].upper;
+			widen(lit->getID(), change);
+			break;
+		default:
+			widen(lit->getID(), change);
+			break;
+		}
+	}
+
+	/*-------------*/
+	/* expressions */
+	/*-------------*/
+
+	void Reachability::visit_plus_expression(VAL::plus_expression * s) {
+
+		s->getLHS()->visit(this);
+		s->getRHS()->visit(this);
+
+		Interval rhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+		Interval lhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+
+		Interval sum = {lhs.lower + rhs.lower, lhs.upper + rhs.upper};
+		reach_expression_stack.push_back(sum);
+	}
+
+	void Reachability::visit_minus_expression(VAL::minus_expression * s) {
+
+		s->getLHS()->visit(this);
+		s->getRHS()->visit(this);
+
+		Interval rhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+		Interval lhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+
+		Interval difference = {lhs.lower - rhs.upper, lhs.upper - rhs.lower};
+		reach_expression_stack.push_back(difference);
+	}
+
+	void Reachability::visit_mul_expression(VAL::mul_expression * s) {
+
+		s->getLHS()->visit(this);
+		s->getRHS()->visit(this);
+
+		Interval rhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+		Interval lhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+
+		double p[4] = {
+			product(lhs.lower, rhs.lower), product(lhs.lower, rhs.upper),
+			product(lhs.upper, rhs.lower), product(lhs.upper, rhs.upper)};
+		Interval result = {*std::min_element(p, p+4), *std::max_element(p, p+4)};
+		reach_expression_stack.push_back(result);
+	}
+
+	void Reachability::visit_div_expression(VAL::div_expression * s) {
+
+		s->getLHS()->visit(this);
+		s->getRHS()->visit(this);
+
+		Interval rhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+		Interval lhs = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+
+		// division by an interval containing zero could be anything
+		if(rhs.lower <= 0 && rhs.upper >= 0) {
+			reach_expression_stack.push_back(unbounded());
+			return;
+		}
+
+		double p[4] = {
+			lhs.lower / rhs.lower, lhs.lower / rhs.upper,
+			lhs.upper / rhs.lower, lhs.upper / rhs.upper};
+		for(int i=0; i<4; i++) {
+			if(std::isnan(p[i])) {
+				reach_expression_stack.push_back(unbounded());
+				return;
+			}
+		}
+		Interval result = {*std::min_element(p, p+4), *std::max_element(p, p+4)};
+		reach_expression_stack.push_back(result);
+	}
+
+	void Reachability::visit_uminus_expression(VAL::uminus_expression * s) {
+
+		s->getExpr()->visit(this);
+
+		Interval exp = reach_expression_stack.back();
+		reach_expression_stack.pop_back();
+
+		Interval result = {-exp.upper, -exp.lower};
+		reach_expression_stack.push_back(result);
+	}
+
+	void Reachability::visit_int_expression(VAL::int_expression * s) {
+		Interval value = {static_cast<double>(s->double_value()), static_cast<double>(s->double_value())};
+		reach_expression_stack.push_back(value);
+	}
+
+	void Reachability::visit_float_expression(VAL::float_expression * s) {
+		Interval value = {static_cast<double>(s->double_value()), static_cast<double>(s->double_value())};
+		reach_expression_stack.push_back(value);
+	}
+
+	/* #t, ?duration and total-time are all non-negative */
+	void Reachability::visit_special_val_expr(VAL::special_val_expr * s) {
+		Interval value = {0, std::numeric_limits<double>::infinity()};
+		reach_expression_stack.push_back(value);
+	}
+
+	void Reachability::visit_func_term(VAL::func_term * s) {
+
+		Inst::PNE * l = new Inst::PNE(s, fe);
+		Inst::PNE * const lit = Inst::instantiatedOp::findPNE(l);
+		delete l;
+
+		if(!lit) reach_expression_stack.push_back(unbounded());
+		else reach_expression_stack.push_back(function_bounds[lit->getID()]);
+	}
+
+} // close namespace
@@ -3,10 +3,14 @@
  */
 #include "SMTPlan/Algebraist.h"
 #include "SMTPlan/Encoder.h"
+#include "SMTPlan/EncodingCache.h"
 #include "SMTPlan/EncoderFluent.h"
 #include "SMTPlan/EncoderHappening.h"
+#include "SMTPlan/HorizonSearch.h"
+#include "SMTPlan/Planner.h"
 #include "SMTPlan/PlannerOptions.h"
 #include "SMTPlan/ProblemInfo.h"
+#include "SMTPlan/SolverPortfolio.h"
 #include "SMTPlanConfig.h"
 
 #include <algorithm>
@@ -26,7 +30,7 @@
 #include "ptree.h"
 #include "typecheck.h"
 
-int number_of_arguments = 9;
+int number_of_arguments = 23;
 SMTPlan::Argument argument[] = {
     {"-h", false, "\tPrint this and exit."},
     {"-l", true,
@@ -41,8 +45,51 @@ SMTPlan::Argument argument[] = {
     {"-e", true,
      "number\tChoose which encoding to use:\n\t\t\t0\tHappening-based encoding "
      "described in the paper (default)"},
+    {"-r", false,
+     "\tRemove operators that are unreachable in a relaxed planning graph "
+     "before encoding."},
+    {"-g", false,
+     "\tAs -r, and with the happening encoder fix operators and literals to "
+     "false at happenings before their first layer in the planning graph."},
+    {"-a", false,
+     "\tAdd at-most-one constraints over literals that TIM invariants show "
+     "to be mutually exclusive (happening encoding only)."},
+    {"-f", false,
+     "\tEncode each group of literals that TIM invariants show to hold "
+     "exactly one at a time as one finite-domain state variable (happening "
+     "encoding only)."},
+    {"-S", false,
+     "\tBreak symmetries between interchangeable objects by ordering the "
+     "actions of symmetric plans (happening encoding only)."},
     {"-s", true,
      "number\tIteratively deepen with a step size of s (default 1)."},
+    {"-x", false,
+     "\tProbe horizons exponentially (l, 2l, 4l, ...) instead of deepening "
+     "with step s."},
+    {"-m", false,
+     "\tWith -x, bisect below the first satisfiable horizon to find the "
+     "shortest plan."},
+    {"-j", true,
+     "number\tSolve j horizons at once in separate threads, reporting the "
+     "shortest plan (default 1, not with -x)."},
+    {"-k", true,
+     "number\tGround k operator schemas at once in separate threads "
+     "(default 1)."},
+    {"-t", true,
+     "strategy\tz3 tactic used to solve, or a pipeline of tactics separated "
+     "by '>' (default auto: qflra for linear domains, otherwise qfnra-nlsat)."},
+    {"-p", true,
+     "list\tRace a comma separated list of strategies on each horizon, or "
+     "\"default\" for a built-in portfolio."},
+    {"-w", true,
+     "file\tSolve with the strategy stored in file if there is one and -t "
+     "is not given, otherwise record the strategy that wins the race."},
+    {"-i", false,
+     "\tSolve incrementally, keeping one solver for the logic of -t and its "
+     "learned lemmas across horizons."},
+    {"-C", true,
+     "dir\tStore the encoding and result of each horizon in dir, and reuse "
+     "them on later runs of the same problem."},
     {"-n", false, "\tDo not solve. Output encoding in smt2 format and exit."},
     {"-v", false, "\tVerbose times."},
     {"-d", false, "\tDebug output."}};
@@ -76,9 +123,22 @@ bool parseArguments(int argc, char *argv[], SMTPlan::PlannerOptions &options) {
   options.upper_bound = -1;
   options.cascade_bound = 1;
   options.step_size = 1;
+  options.exponential = false;
+  options.minimal = false;
   options.encoder = 0;
+  options.reachability = false;
+  options.layered = false;
+  options.mutex_groups = false;
+  options.finite_domain = false;
+  options.symmetry = false;
+  options.threads = 1;
+  options.ground_threads = 1;
+  options.strategy = "auto";
+  options.incremental = false;
+  options.cache_dir = "";
 
   // read arguments
+  bool strategy_given = false;
   for (int i = 3; i < argc; i++) {
 
     bool argumentFound = false;
@@ -109,8 +169,42 @@ bool parseArguments(int argc, char *argv[], SMTPlan::PlannerOptions &options) {
         options.cascade_bound = atoi(argv[i]);
         if (options.cascade_bound < 2)
           options.cascade_bound = 2;
+      } else if (argument[j].name == "-r") {
+        options.reachability = true;
+      } else if (argument[j].name == "-g") {
+        options.reachability = true;
+        options.layered = true;
+      } else if (argument[j].name == "-a") {
+        options.mutex_groups = true;
+      } else if (argument[j].name == "-f") {
+        options.finite_domain = true;
+      } else if (argument[j].name == "-S") {
+        options.symmetry = true;
       } else if (argument[j].name == "-s") {
         options.step_size = atoi(argv[i]);
+      } else if (argument[j].name == "-x") {
+        options.exponential = true;
+      } else if (argument[j].name == "-m") {
+        options.minimal = true;
+      } else if (argument[j].name == "-j") {
+        options.threads = atoi(argv[i]);
+        if (options.threads < 1)
+          options.threads = 1;
+      } else if (argument[j].name == "-k") {
+        options.ground_threads = atoi(argv[i]);
+        if (options.ground_threads < 1)
+          options.ground_threads = 1;
+      } else if (argument[j].name == "-t") {
+        options.strategy = argv[i];
+        strategy_given = true;
+      } else if (argument[j].name == "-p") {
+        options.portfolio = SMTPlan::parse_portfolio(argv[i]);
+      } else if (argument[j].name == "-w") {
+        options.strategy_file = argv[i];
+      } else if (argument[j].name == "-i") {
+        options.incremental = true;
+      } else if (argument[j].name == "-C") {
+        options.cache_dir = argv[i];
       } else if (argument[j].name == "-n") {
         options.solve = false;
       } else if (argument[j].name == "-v") {
@@ -127,9 +221,71 @@ bool parseArguments(int argc, char *argv[], SMTPlan::PlannerOptions &options) {
     }
   }
 
+  // the exponential probes are solved one at a time
+  if (options.exponential && options.threads > 1) {
+    std::cerr << "-x cannot be combined with -j" << std::endl;
+    return false;
+  }
+
+  // use the strategy that won last time, unless one was given
+  if (!strategy_given && options.strategy_file != "" &&
+      SMTPlan::SolverPortfolio::readStrategy(options.strategy_file,
+                                             options.strategy)) {
+    options.portfolio.clear();
+  }
+  if (options.portfolio.size() == 1) {
+    options.strategy = options.portfolio[0];
+    options.portfolio.clear();
+  }
+
+  // check strategies
+  z3::context ctx;
+  std::vector<std::string> strategies = options.portfolio;
+  strategies.push_back(options.strategy);
+  for (unsigned int i = 0; i < strategies.size(); i++) {
+    if (strategies[i] == "auto")
+      continue;
+    try {
+      SMTPlan::mk_strategy(ctx, strategies[i]);
+    } catch (z3::exception &e) {
+      std::cerr << "Unknown strategy: " << strategies[i] << std::endl;
+      return false;
+    }
+  }
+
   return true;
 }
 
+/*--------------------*/
+/* choosing the logic */
+/*--------------------*/
+
+void resolveStrategy(SMTPlan::PlannerOptions &options, bool linear) {
+
+  std::string logic = linear ? "qflra" : "qfnra-nlsat";
+  if (options.strategy == "auto")
+    options.strategy = logic;
+  std::replace(options.portfolio.begin(), options.portfolio.end(),
+               std::string("auto"), logic);
+}
+
+/*----------------------*/
+/* recording the winner */
+/*----------------------*/
+
+void recordStrategy(SMTPlan::PlannerOptions &options,
+                    SMTPlan::Encoder *encoder) {
+
+  if (!encoder->z3_portfolio || encoder->z3_portfolio->winner == "")
+    return;
+  if (options.verbose)
+    fprintf(stdout, "Strategy:\t%s\n",
+            encoder->z3_portfolio->winner.c_str());
+  if (options.strategy_file != "")
+    SMTPlan::SolverPortfolio::writeStrategy(options.strategy_file,
+                                            encoder->z3_portfolio->winner);
+}
+
 /*-------*/
 /* timer */
 /*-------*/
@@ -170,96 +326,120 @@ int main(int argc, char *argv[]) {
 
   getElapsed();
 
-  SMTPlan::ProblemInfo pi;
-
-  // parse domain and problem
-  TIM::performTIMAnalysis(&argv[1]);
-  Inst::SimpleEvaluator::setInitialState();
-
-  VAL::operator_list::const_iterator os =
-      VAL::current_analysis->the_domain->ops->begin();
-
-  for (; os != VAL::current_analysis->the_domain->ops->end(); ++os) {
-    Inst::instantiatedOp::instantiate(*os, VAL::current_analysis->the_problem,
-                                      *VAL::theTC);
-  };
-
-  Inst::instantiatedOp::createAllLiterals(VAL::current_analysis->the_problem,
-                                          VAL::theTC);
-  Inst::instantiatedOp::filterOps(VAL::theTC);
-
-  // save static predicates
-  if (VAL::current_analysis->the_domain->predicates) {
-
-    VAL::pred_decl_list *predicates =
-        VAL::current_analysis->the_domain->predicates;
-
-    for (VAL::pred_decl_list::const_iterator ci = predicates->begin();
-         ci != predicates->end(); ci++) {
-
-      VAL::holding_pred_symbol *hps = HPS((*ci)->getPred());
-      bool isStatic = true;
-
-      for (VAL::holding_pred_symbol::PIt i = hps->pBegin(); i != hps->pEnd();
-           ++i) {
-
-        TIM::TIMpredSymbol *tps = const_cast<TIM::TIMpredSymbol *>(
-            static_cast<const TIM::TIMpredSymbol *>(*i));
-        if (!tps->isDefinitelyStatic() || !tps->isStatic()) {
-          isStatic = false;
-          break;
-        }
-
+  // solve the horizons already in the encoding cache
+  SMTPlan::EncodingCache cache(options);
+  int first_horizon = options.lower_bound;
+  int undecided = 0;
+  if (options.solve && cache.enabled()) {
+    for (; (options.upper_bound < 0 || first_horizon <= options.upper_bound) &&
+           cache.has(first_horizon);
+         first_horizon += options.step_size) {
+      z3::check_result result = cache.solve(first_horizon);
+      if (result == z3::sat) {
+        cache.printModel();
+
+        fprintf(stdout, "SAT Solution: %f \n", getElapsed());
+        fprintf(stdout, "Iterations: %i \n", first_horizon);
+        fprintf(stdout, "Total time: %f \n", getTotalElapsed());
+        return 0;
       }
-      pi.staticPredicateMap[hps->getName()] = isStatic;
+      if (result == z3::unknown) {
+        undecided++;
+        fprintf(stdout, "UNKNOWN Solution %i: %f \n", first_horizon,
+                getElapsed());
+      } else
+        fprintf(stdout, "UNSAT Solution %i: %f \n", first_horizon,
+                getElapsed());
     }
-  }
-
-  // save static functions
-  if (VAL::current_analysis->the_domain->functions) {
-
-    VAL::func_decl_list *functions =
-        VAL::current_analysis->the_domain->functions;
-
-    for (VAL::func_decl_list::const_iterator ci = functions->begin();
-         ci != functions->end(); ci++) {
-
-      VAL::extended_func_symbol *efs = static_cast<VAL::extended_func_symbol *>(
-          const_cast<VAL::func_symbol *>((*ci)->getFunction()));
-      pi.staticFunctionMap[efs->getName()] = efs->isStatic();
-
+    if (options.upper_bound >= 0 && first_horizon > options.upper_bound) {
+      fprintf(stdout, "Timeout at %i\n", options.upper_bound);
+      fprintf(stdout, "Unknown: %i \n", undecided);
+      fprintf(stdout, "Total time: %f \n", getTotalElapsed());
+      return 0;
     }
   }
 
+  // parse and ground domain and problem
+  SMTPlan::Planner planner(options);
+  planner.ground();
+  Inst::GroundingStats &gs = planner.grounding_stats;
+  fprintf(stdout, "Grounding: %li %li %li %i \n", gs.candidates, gs.pruned,
+          gs.evaluated, planner.grounded_ops);
+  if (options.reachability)
+    fprintf(stdout, "Unreachable: %i %i \n", planner.pruned_ops,
+            planner.pruned_literals);
+  if (options.mutex_groups || options.finite_domain)
+    fprintf(stdout, "Mutex groups: %i %i \n",
+            (int)planner.problem_info.mutexGroups.size(),
+            planner.grouped_literals);
+  if (options.symmetry)
+    fprintf(stdout, "Symmetries: %i %i \n",
+            (int)planner.problem_info.operatorSymmetries.size(),
+            planner.symmetric_objects);
+
   // if (options.verbose)
   fprintf(stdout, "Grounded: %f \n", getElapsed());
 
   // calculate boundary expressions for continuous change
-  SMTPlan::Algebraist algebraist(VAL::current_analysis, options, pi);
-  algebraist.processDomain();
+  if (!planner.processDomain())
+    return 1;
+  SMTPlan::Algebraist &algebraist = *planner.algebraist;
+  resolveStrategy(options, algebraist.linear);
 
   // if (options.verbose)
   fprintf(stdout, "Algebra: %f \n", getElapsed());
 
+  // solve several horizons at once, or probe exponentially
+  if (options.solve && (options.threads > 1 || options.exponential)) {
+    // the horizons solved from the cache are not searched again
+    options.lower_bound = first_horizon;
+    SMTPlan::Planner::Scope scope(planner);
+    SMTPlan::HorizonSearch search(&algebraist, VAL::current_analysis, options,
+                                  planner.problem_info);
+    search.cache = &cache;
+    int horizon;
+    SMTPlan::Encoder *encoder = options.exponential
+                                    ? search.searchExponential(horizon)
+                                    : search.searchParallel(horizon);
+    if (encoder) {
+      encoder->printModel();
+      recordStrategy(options, encoder);
+
+      fprintf(stdout, "SAT Solution: %f \n", getElapsed());
+      fprintf(stdout, "Iterations: %i \n", horizon);
+      if (options.exponential && options.minimal)
+        fprintf(stdout, "Unknown below: %i \n",
+                horizon - search.unsat_horizon - 1);
+      fprintf(stdout, "Total time: %f \n", getTotalElapsed());
+      delete encoder;
+      return 0;
+    }
+    fprintf(stdout, "Timeout at %i\n", options.upper_bound);
+    fprintf(stdout, "Unknown: %i \n", search.undecided);
+    fprintf(stdout, "Total time: %f \n", getTotalElapsed());
+    return 0;
+  }
+
   // begin search loop
   SMTPlan::Encoder *encoder;
-  if (options.encoder == 0) {
-    encoder = new SMTPlan::EncoderHappening(&algebraist, VAL::current_analysis,
-                                            options, pi);
-  } else if (options.encoder == 1) {
-    encoder = new SMTPlan::EncoderFluent(&algebraist, VAL::current_analysis,
-                                         options, pi);
-  } else {
+  {
+    SMTPlan::Planner::Scope scope(planner);
+    encoder = planner.createEncoder();
+  }
+  if (!encoder) {
     fprintf(stdout, "Uknown encoding selected.\n");
     return 0;
   }
 
-  for (int i = options.lower_bound;
+  for (int i = first_horizon;
        (options.upper_bound < 0 || i <= options.upper_bound);
        i += options.step_size) {
 
     // generate encoding
-    encoder->encode(i);
+    {
+      SMTPlan::Planner::Scope scope(planner);
+      encoder->encode(i);
+    }
 
     fprintf(stdout, "Encoded %i: %f \n", i, getElapsed());
 
@@ -273,11 +453,17 @@ int main(int argc, char *argv[]) {
       return 0;
     }
 
+    // store for later runs
+    if (cache.enabled())
+      cache.store(i, encoder, algebraist.linear);
+
     // solve
     z3::check_result result = encoder->solve();
+    cache.storeResult(i, encoder, result);
 
     if (result == z3::sat) {
       encoder->printModel();
+      recordStrategy(options, encoder);
 
       fprintf(stdout, "SAT Solution: %f \n", getElapsed());
       fprintf(stdout, "Iterations: %i \n", i);
@@ -287,13 +473,19 @@ int main(int argc, char *argv[]) {
       return 0;
     }
 
-    fprintf(stdout, "UNSAT Solution %i: %f \n", i, getElapsed());
+    // the solver gave up or timed out, so this horizon is not ruled out
+    if (result == z3::unknown) {
+      undecided++;
+      fprintf(stdout, "UNKNOWN Solution %i: %f \n", i, getElapsed());
+    } else
+      fprintf(stdout, "UNSAT Solution %i: %f \n", i, getElapsed());
   }
 
   fprintf(stdout, "Timeout at %i\n", options.upper_bound);
+  fprintf(stdout, "Unknown: %i \n", undecided);
   fprintf(stdout, "Total time: %f \n", getTotalElapsed());
 
-  // delete *encoder;
+  delete encoder;
 
   return 0;
 }
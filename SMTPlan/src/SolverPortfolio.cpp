@@ -0,0 +1,212 @@
+#include "SMTPlan/SolverPortfolio.h"
+
+/* implementation of SMTPlan::SolverPortfolio */
+namespace SMTPlan {
+
+	z3::tactic mk_strategy(z3::context &ctx, const std::string &strategy) {
+		std::string::size_type split = strategy.find('>');
+		if(split == std::string::npos)
+			return z3::tactic(ctx, strategy.c_str());
+		return z3::tactic(ctx, strategy.substr(0, split).c_str()) & mk_strategy(ctx, strategy.substr(split + 1));
+	}
+
+	z3::solver mk_solver(z3::context &ctx, const std::string &strategy, bool incremental) {
+		if(incremental && strategy == "smt")
+			return z3::solver(ctx);
+		if(incremental && strategy.find('>') == std::string::npos && strategy.compare(0, 2, "qf") == 0) {
+			std::string logic = strategy.substr(2, strategy.find('-') - 2);
+			std::transform(logic.begin(), logic.end(), logic.begin(), ::toupper);
+			return z3::solver(ctx, ("QF_" + logic).c_str());
+		}
+		return mk_strategy(ctx, strategy).mk_solver();
+	}
+
+	std::vector<std::string> parse_portfolio(const std::string &list) {
+		std::vector<std::string> strategies;
+		std::stringstream ss(list);
+		std::string strategy;
+		while(std::getline(ss, strategy, ',')) {
+			if(strategy == "default") {
+				strategies.push_back("qfnra-nlsat");
+				strategies.push_back("qflra");
+				strategies.push_back("smt");
+				strategies.push_back("simplify>propagate-values>solve-eqs>smt");
+			} else if(strategy != "") {
+				strategies.push_back(strategy);
+			}
+		}
+		return strategies;
+	}
+
+	/**
+	 * Copy the new part of the encoding into the context of each strategy,
+	 * then run them all and wait. The first sat or unsat answer cancels the rest.
+	 */
+	z3::check_result SolverPortfolio::solve(z3::solver &solver, std::vector<z3::expr> &assumptions, z3::model *&model) {
+
+		z3::expr_vector src_assumptions(solver.ctx());
+		std::vector<z3::expr>::iterator ait = assumptions.begin();
+		for(; ait != assumptions.end(); ait++)
+			src_assumptions.push_back(*ait);
+		z3::expr_vector src_assertions = solver.assertions();
+
+		bool racing;
+		{
+			boost::mutex::scoped_lock lock(race_mutex);
+			race_result = z3::unknown;
+			race_winner = -1;
+
+			if(entrants.empty()) {
+				std::vector<std::string>::iterator sit = strategies.begin();
+				for(; sit != strategies.end(); sit++) {
+					Entrant e;
+					e.strategy = *sit;
+					e.context = NULL;
+					e.solver = NULL;
+					e.assumptions = NULL;
+					entrants.push_back(e);
+					resetEntrant(entrants.back());
+				}
+			}
+
+			for(unsigned int i=0; i<entrants.size() && !cancelled; i++) {
+
+				Entrant &e = entrants[i];
+				if(e.interrupted) resetEntrant(e);
+
+				// assertions added since the last race
+				if(e.translated < src_assertions.size()) {
+					z3::expr_vector added(solver.ctx());
+					for(unsigned int j=e.translated; j<src_assertions.size(); j++)
+						added.push_back(src_assertions[j]);
+					z3::expr_vector assertions(*e.context, added);
+					for(unsigned int j=0; j<assertions.size(); j++)
+						e.solver->add(assertions[j]);
+					e.translated = src_assertions.size();
+				}
+
+				delete e.assumptions;
+				e.assumptions = new z3::expr_vector(*e.context, src_assumptions);
+				e.result = z3::unknown;
+				e.done = false;
+			}
+			racing = !cancelled;
+		}
+
+		boost::thread_group racers;
+		if(racing) {
+			for(unsigned int e=0; e<entrants.size(); e++)
+				racers.create_thread(boost::bind(&SolverPortfolio::runEntrant, this, e));
+		}
+		racers.join_all();
+
+		boost::mutex::scoped_lock lock(race_mutex);
+
+		winner = "";
+		if(race_winner >= 0) {
+			winner = entrants[race_winner].strategy;
+			if(race_result == z3::sat) {
+				z3::model m = entrants[race_winner].solver->get_model();
+				if(model) delete model;
+				model = new z3::model(m, solver.ctx(), z3::model::translate());
+			}
+		}
+
+		cancelled = false;
+		return race_result;
+	}
+
+	/**
+	 * A single strategy. A strategy that cannot handle the encoding
+	 * (e.g. qflra on nonlinear constraints) gives up with unknown.
+	 */
+	void SolverPortfolio::runEntrant(int e) {
+
+		Entrant &entrant = entrants[e];
+		z3::check_result result = z3::unknown;
+
+		// z3 clears an interrupt when a check starts, so one made before is lost
+		{
+			boost::mutex::scoped_lock lock(race_mutex);
+			if(cancelled || race_winner >= 0) {
+				entrant.done = true;
+				return;
+			}
+		}
+
+		try {
+			result = entrant.solver->check(*entrant.assumptions);
+		} catch(z3::exception &ex) {
+			// failed or interrupted
+		}
+
+		boost::mutex::scoped_lock lock(race_mutex);
+		entrant.result = result;
+		entrant.done = true;
+		if(result == z3::unknown || race_winner >= 0) return;
+
+		race_winner = e;
+		race_result = result;
+		for(unsigned int i=0; i<entrants.size(); i++) {
+			if(entrants[i].done) continue;
+			entrants[i].context->interrupt();
+			entrants[i].interrupted = true;
+		}
+	}
+
+	void SolverPortfolio::interrupt() {
+		boost::mutex::scoped_lock lock(race_mutex);
+		cancelled = true;
+		for(unsigned int i=0; i<entrants.size(); i++) {
+			if(entrants[i].done) continue;
+			entrants[i].context->interrupt();
+			entrants[i].interrupted = true;
+		}
+	}
+
+	/* objects must be freed before the context that made them */
+	void SolverPortfolio::resetEntrant(Entrant &entrant) {
+		if(entrant.assumptions) delete entrant.assumptions;
+		if(entrant.solver) delete entrant.solver;
+		if(entrant.context) delete entrant.context;
+
+		z3::config cfg;
+		cfg.set("auto_config", true);
+		entrant.context = new z3::context(cfg);
+		entrant.solver = new z3::solver(mk_solver(*entrant.context, entrant.strategy, incremental));
+		entrant.assumptions = NULL;
+		entrant.result = z3::unknown;
+		entrant.translated = 0;
+		entrant.done = true;
+		entrant.interrupted = false;
+	}
+
+	void SolverPortfolio::clearEntrants() {
+		std::vector<Entrant>::iterator eit = entrants.begin();
+		for(; eit != entrants.end(); eit++) {
+			if(eit->assumptions) delete eit->assumptions;
+			delete eit->solver;
+			delete eit->context;
+		}
+		entrants.clear();
+	}
+
+	/*-----------------*/
+	/* strategy record */
+	/*-----------------*/
+
+	bool SolverPortfolio::readStrategy(const std::string &path, std::string &strategy) {
+		std::ifstream file(path.c_str());
+		std::string line;
+		if(!file.is_open() || !std::getline(file, line) || line == "")
+			return false;
+		strategy = line;
+		return true;
+	}
+
+	void SolverPortfolio::writeStrategy(const std::string &path, const std::string &strategy) {
+		std::ofstream file(path.c_str());
+		if(file.is_open()) file << strategy << std::endl;
+	}
+
+} // close namespace
@@ -0,0 +1,169 @@
+#include "SMTPlan/Symmetries.h"
+
+/* implementation of SMTPlan::Symmetries */
+namespace SMTPlan {
+
+	Symmetries::Atom Symmetries::swap(const Atom &atom, const void * a, const void * b) {
+		Atom swapped(atom);
+		for(unsigned int i=1; i<swapped.size(); i++) {
+			if(swapped[i] == a) swapped[i] = b;
+			else if(swapped[i] == b) swapped[i] = a;
+		}
+		return swapped;
+	}
+
+	/* only conjunctions of literals are understood, anything else gives up */
+	bool Symmetries::collectGoal(const VAL::goal * g) {
+
+		if(const VAL::conj_goal * cg = dynamic_cast<const VAL::conj_goal *>(g)) {
+			for(VAL::goal_list::const_iterator i = cg->getGoals()->begin(); i != cg->getGoals()->end(); ++i)
+				if(!collectGoal(*i)) return false;
+			return true;
+		}
+
+		const VAL::simple_goal * sg = dynamic_cast<const VAL::simple_goal *>(g);
+		bool positive = true;
+		if(const VAL::neg_goal * ng = dynamic_cast<const VAL::neg_goal *>(g)) {
+			sg = dynamic_cast<const VAL::simple_goal *>(ng->getGoal());
+			positive = false;
+		}
+		if(!sg) return false;
+		if(sg->getPolarity() == VAL::E_NEG) positive = !positive;
+
+		Atom atom(1, sg->getProp()->head);
+		for(VAL::parameter_symbol_list::const_iterator i = sg->getProp()->args->begin(); i != sg->getProp()->args->end(); ++i)
+			atom.push_back(*i);
+		// negative goals are marked by a null after the arguments
+		if(!positive) atom.push_back(NULL);
+		goal_atoms.insert(atom);
+		return true;
+	}
+
+	bool Symmetries::interchangeable(const VAL::const_symbol * a, const VAL::const_symbol * b) {
+
+		std::set<Atom>::const_iterator i = initial_atoms.begin();
+		for(; i != initial_atoms.end(); ++i)
+			if(!initial_atoms.count(swap(*i, a, b))) return false;
+
+		std::map<Atom, double>::const_iterator v = initial_values.begin();
+		for(; v != initial_values.end(); ++v) {
+			std::map<Atom, double>::const_iterator w = initial_values.find(swap(v->first, a, b));
+			if(w == initial_values.end() || w->second != v->second) return false;
+		}
+
+		for(i = goal_atoms.begin(); i != goal_atoms.end(); ++i)
+			if(!goal_atoms.count(swap(*i, a, b))) return false;
+
+		return true;
+	}
+
+	void Symmetries::collectGrounding() {
+
+		Inst::LiteralStore::iterator litItr = Inst::instantiatedOp::literalsBegin();
+		const Inst::LiteralStore::iterator litEnd = Inst::instantiatedOp::literalsEnd();
+		for (; litItr != litEnd; ++litItr) {
+			Atom atom(1, (*litItr)->getHead());
+			for(VAL::LiteralParameterIterator<VAL::parameter_symbol_list::iterator> i = (*litItr)->begin(); i != (*litItr)->end(); ++i)
+				atom.push_back(*i);
+			literal_atoms.insert(atom);
+		}
+
+		Inst::PNEStore::iterator pneItr = Inst::instantiatedOp::pnesBegin();
+		const Inst::PNEStore::iterator pneEnd = Inst::instantiatedOp::pnesEnd();
+		for(; pneItr != pneEnd; ++pneItr) {
+			Atom atom(1, (*pneItr)->getHead());
+			for(VAL::LiteralParameterIterator<VAL::parameter_symbol_list::const_iterator> i = (*pneItr)->begin(); i != (*pneItr)->end(); ++i)
+				atom.push_back(*i);
+			pne_atoms.insert(atom);
+		}
+
+		Inst::OpStore::iterator opsItr = Inst::instantiatedOp::opsBegin();
+		const Inst::OpStore::iterator opsEnd = Inst::instantiatedOp::opsEnd();
+		for (; opsItr != opsEnd; ++opsItr) {
+			Atom atom(1, (*opsItr)->forOp());
+			for(int i=0; i<(*opsItr)->arity(); i++)
+				atom.push_back((*opsItr)->getArg(i));
+			op_ids[atom] = (*opsItr)->getID();
+			op_atoms.push_back(atom);
+		}
+	}
+
+	/**
+	 * The swap is kept only if it maps every ground operator, literal
+	 * and function onto another, as pruning may have broken the symmetry.
+	 */
+	bool Symmetries::permutation(const VAL::const_symbol * a, const VAL::const_symbol * b, std::vector<int> &ops) {
+
+		for(std::set<Atom>::const_iterator i = literal_atoms.begin(); i != literal_atoms.end(); ++i)
+			if(!literal_atoms.count(swap(*i, a, b))) return false;
+
+		for(std::set<Atom>::const_iterator i = pne_atoms.begin(); i != pne_atoms.end(); ++i)
+			if(!pne_atoms.count(swap(*i, a, b))) return false;
+
+		ops.assign(op_atoms.size(), -1);
+		for(unsigned int i=0; i<op_atoms.size(); i++) {
+			std::map<Atom, int>::const_iterator image = op_ids.find(swap(op_atoms[i], a, b));
+			if(image == op_ids.end()) return false;
+			ops[op_ids[op_atoms[i]]] = image->second;
+		}
+		return true;
+	}
+
+	void Symmetries::find() {
+
+		VAL::problem * prb = val_analysis->the_problem;
+		if(!prb->objects || prb->constraints) return;
+		if(!prb->initial_state->timed_effects.empty()) return;
+
+		// initial state
+		for(VAL::pc_list<VAL::simple_effect*>::const_iterator ci = prb->initial_state->add_effects.begin(); ci != prb->initial_state->add_effects.end(); ci++) {
+			Atom atom(1, (*ci)->prop->head);
+			for(VAL::parameter_symbol_list::const_iterator i = (*ci)->prop->args->begin(); i != (*ci)->prop->args->end(); ++i)
+				atom.push_back(*i);
+			initial_atoms.insert(atom);
+		}
+		for(VAL::pc_list<VAL::assignment*>::const_iterator ci = prb->initial_state->assign_effects.begin(); ci != prb->initial_state->assign_effects.end(); ci++) {
+			const VAL::num_expression * value = dynamic_cast<const VAL::num_expression *>((*ci)->getExpr());
+			if(!value) return;
+			Atom atom(1, (*ci)->getFTerm()->getFunction());
+			for(VAL::parameter_symbol_list::const_iterator i = (*ci)->getFTerm()->getArgs()->begin(); i != (*ci)->getFTerm()->getArgs()->end(); ++i)
+				atom.push_back(*i);
+			initial_values[atom] = value->double_value();
+		}
+
+		// goal
+		if(prb->the_goal && !collectGoal(prb->the_goal)) return;
+
+		// objects named by the domain are never swapped
+		std::set<const VAL::const_symbol *> fixed;
+		if(val_analysis->the_domain->constants)
+			fixed.insert(val_analysis->the_domain->constants->begin(), val_analysis->the_domain->constants->end());
+
+		// classes of interchangeable objects of the same type
+		std::vector<std::vector<const VAL::const_symbol *> > classes;
+		for(VAL::const_symbol_list::const_iterator o = prb->objects->begin(); o != prb->objects->end(); ++o) {
+			if(fixed.count(*o) || !(*o)->type || (*o)->either_types) continue;
+			bool placed = false;
+			for(unsigned int c=0; c<classes.size() && !placed; c++) {
+				if(classes[c][0]->type != (*o)->type) continue;
+				if(interchangeable(classes[c][0], *o)) {
+					classes[c].push_back(*o);
+					placed = true;
+				}
+			}
+			if(!placed) classes.push_back(std::vector<const VAL::const_symbol *>(1, *o));
+		}
+
+		collectGrounding();
+		for(unsigned int c=0; c<classes.size(); c++) {
+			if(classes[c].size() < 2) continue;
+			symmetric_objects += classes[c].size();
+			for(unsigned int i=0; i+1<classes[c].size(); i++) {
+				std::vector<int> ops;
+				if(permutation(classes[c][i], classes[c][i+1], ops))
+					problem_info->operatorSymmetries.push_back(ops);
+			}
+		}
+	}
+
+} // close namespace
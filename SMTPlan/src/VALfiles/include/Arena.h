@@ -0,0 +1,135 @@
+/************************************************************************
+ * Copyright 2008, Strathclyde Planning Group,
+ * Department of Computer and Information Sciences,
+ * University of Strathclyde, Glasgow, UK
+ * http://planning.cis.strath.ac.uk/
+ *
+ * Maria Fox, Richard Howey and Derek Long - VAL
+ * Stephen Cresswell - PDDL Parser
+ *
+ * This file is part of VAL, the PDDL validator.
+ *
+ * VAL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * VAL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with VAL.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ************************************************************************/
+
+#ifndef __ARENA
+#define __ARENA
+
+#include <cstddef>
+#include <vector>
+using std::vector;
+
+namespace VAL {
+
+/* Memory taken from large blocks and released all at once.
+ *
+ * Each thread has a current arena, possibly none. Arena::allocate takes
+ * memory from it, or from the heap when there is none, and
+ * Arena::deallocate returns memory to wherever it came from. Freeing
+ * arena memory only reclaims it if it was the last allocation made in
+ * the thread's current arena. Everything else is kept until the arena
+ * is released.
+ *
+ * Releasing an arena does not run destructors. Objects kept in an arena
+ * must own nothing except other arena memory.
+ */
+class Arena {
+private:
+	vector<char *> blocks;
+	char * next;
+	char * end;
+
+	static __thread Arena * current_;
+
+	Arena(const Arena &);
+	Arena & operator=(const Arena &);
+
+	void * take(size_t size);
+
+public:
+	Arena() : next(0), end(0) {};
+	~Arena() {release();};
+
+	/* free every block of the arena */
+	void release();
+
+	/* take over the blocks of other, leaving it empty */
+	void adopt(Arena & other);
+
+	static Arena * current() {return current_;};
+
+	/* make a the current arena of this thread, returning the previous one */
+	static Arena * setCurrent(Arena * a)
+	{
+		Arena * p = current_;
+		current_ = a;
+		return p;
+	};
+
+	static void * allocate(size_t size) {return allocate(size,current_);};
+	static void * allocate(size_t size,Arena * a);
+	static void deallocate(void * p);
+
+	/* makes an arena current for the lifetime of the Use */
+	class Use {
+	private:
+		Arena * previous;
+	public:
+		Use(Arena & a) : previous(setCurrent(&a)) {};
+		~Use() {setCurrent(previous);};
+	};
+};
+
+/* An allocator for containers held by arena objects */
+template<typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+	typedef T * pointer;
+	typedef const T * const_pointer;
+	typedef T & reference;
+	typedef const T & const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<typename U>
+	struct rebind {typedef ArenaAllocator<U> other;};
+
+	ArenaAllocator() {};
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U> &) {};
+
+	pointer address(reference x) const {return &x;};
+	const_pointer address(const_reference x) const {return &x;};
+	size_type max_size() const {return size_t(-1) / sizeof(T);};
+
+	pointer allocate(size_type n,const void * = 0)
+	{
+		return static_cast<pointer>(Arena::allocate(n * sizeof(T)));
+	};
+	void deallocate(pointer p,size_type) {Arena::deallocate(p);};
+
+	void construct(pointer p,const T & t) {new(static_cast<void *>(p)) T(t);};
+	void destroy(pointer p) {p->~T();};
+};
+
+template<typename T,typename U>
+bool operator==(const ArenaAllocator<T> &,const ArenaAllocator<U> &) {return true;};
+template<typename T,typename U>
+bool operator!=(const ArenaAllocator<T> &,const ArenaAllocator<U> &) {return false;};
+
+};
+
+#endif
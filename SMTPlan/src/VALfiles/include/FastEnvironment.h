@@ -34,6 +34,7 @@ using std::vector;
 #include <iterator>
 
 #include "ptree.h"
+#include "Arena.h"
 
 namespace VAL {
 
@@ -102,13 +103,19 @@ public:
 	};
 };
 
+// Environments are copied for every ground instance, so they and their
+// bindings are taken from the current arena when there is one.
 class FastEnvironment {
 private:
-	vector<const_symbol *> syms;
+	typedef vector<const_symbol *,ArenaAllocator<const_symbol *> > Core;
+	Core syms;
 public:
 	FastEnvironment(int x) : syms(x,static_cast<const_symbol*>(0)) {};
 	FastEnvironment(const FastEnvironment & other) : syms(other.syms) {};
 
+	static void * operator new(size_t size) {return Arena::allocate(size);};
+	static void operator delete(void * p) {Arena::deallocate(p);};
+
 	void extend(int x)
 	{
 		syms.resize(syms.size()+x,static_cast<const_symbol*>(0));
@@ -138,10 +145,10 @@ public:
 		return syms[static_cast<const IDsymbol<var_symbol>*>(s)->getId()];
 	};
 
-	typedef vector<const_symbol *>::const_iterator const_iterator;
+	typedef Core::const_iterator const_iterator;
 	const_iterator begin() const {return syms.begin();};
 	const_iterator end() const {return syms.end();};
-	const vector<const_symbol *> & getCore() const {return syms;};
+	vector<const_symbol *> getCore() const {return vector<const_symbol *>(syms.begin(),syms.end());};
 };
 
 
@@ -77,6 +77,8 @@ class InitialStateEvaluator : public PrimitiveEvaluator {
 protected: 
 	friend class ParameterDomainConstraints;
 	friend class LitStoreEvaluator;
+	friend class JoinGrounder;
+	friend struct InstantiationState;
 	static IState initState;
 	static IState0Arity init0State;
 public:
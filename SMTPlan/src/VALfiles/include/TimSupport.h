@@ -475,6 +475,9 @@ public:
 	typedef set<PropertyState*>::const_iterator SIterator;
 	SIterator begin() const {return states.begin();};
 	SIterator end() const {return states.end();};
+	typedef vector<Property *>::const_iterator PIterator;
+	PIterator pbegin() const {return properties.begin();};
+	PIterator pend() const {return properties.end();};
 	int numStates() const {return states.size();};
 	bool isLockingSpace();
 };
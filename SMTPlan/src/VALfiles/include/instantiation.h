@@ -153,6 +153,9 @@ public:
 		};
 	};
 
+	static void * operator new(size_t size) {return VAL::Arena::allocate(size);};
+	static void operator delete(void * p) {VAL::Arena::deallocate(p);};
+
 	const VAL::func_term * toFuncTerm() 
 	{
 		if(!realisation)
@@ -231,6 +234,9 @@ public:
 		};
 	};
 
+	static void * operator new(size_t size) {return VAL::Arena::allocate(size);};
+	static void operator delete(void * p) {VAL::Arena::deallocate(p);};
+
 	const VAL::proposition * toProposition()
 	{
 		if(!realisation)
@@ -341,17 +347,127 @@ struct Purifier<func_symbol> {
 };
 
 
+/* Stores the instances of a family of symbols, keyed on the head symbol
+ * and the tuple of arguments. Entries are kept in insertion order, which
+ * gives each its ID, and indexed by an open addressing hash table.
+ */
 template<typename S,typename V>
 class GenStore {
 private:
-	typedef map<const S *,CascadeMap<VAL::const_symbol *,V> > PredMap;
+	struct Slot {
+		size_t hash;
+		V * value;
+		bool erased;
+
+		Slot() : hash(0), value(0), erased(false) {};
+	};
 
-	PredMap literals;
+	vector<Slot> table;
+	size_t used;		// slots holding a value or erased
 	deque<V *> allLits;
 
+	// the values of each head, in the order they were inserted
+	typedef map<const S *,vector<V *> > ContentMap;
+	ContentMap contents;
+
 	Purifier<S> purify;
 
+	template<typename TI>
+	static size_t hashOf(const S * s,TI b,TI e)
+	{
+		size_t h = reinterpret_cast<size_t>(s);
+		for(;b != e;++b)
+		{
+			const VAL::const_symbol * c = *b;
+			h ^= reinterpret_cast<size_t>(c) + 0x9e3779b9 + (h << 6) + (h >> 2);
+		};
+		return h;
+	};
+
+	template<typename TI,typename TJ>
+	static bool sameArgs(TI b,TI e,TJ vb,TJ ve)
+	{
+		for(;b != e && vb != ve;++b,++vb)
+		{
+			const VAL::const_symbol * x = *b;
+			const VAL::const_symbol * y = *vb;
+			if(x != y) return false;
+		};
+		return b == e && vb == ve;
+	};
+
+	template<typename TI>
+	bool matches(V * v,const S * s,TI b,TI e)
+	{
+		return purify(v->getHead()) == s && sameArgs(b,e,v->begin(),v->end());
+	};
+
+	void grow()
+	{
+		vector<Slot> old(table.empty() ? 64 : table.size()*2);
+		old.swap(table);
+		used = 0;
+		for(typename vector<Slot>::const_iterator i = old.begin();i != old.end();++i)
+		{
+			if(!i->value) continue;
+			size_t x = i->hash & (table.size()-1);
+			while(table[x].value) x = (x+1) & (table.size()-1);
+			table[x].hash = i->hash;
+			table[x].value = i->value;
+			++used;
+		};
+	};
+
+	/* the slot holding the instance, or the slot to insert it into,
+	 * growing the table first if it is too full */
+	template<typename TI>
+	Slot & slot(const S * s,TI b,TI e)
+	{
+		if((used+1)*4 > table.size()*3) grow();
+		const size_t h = hashOf(s,b,e);
+		Slot * free = 0;
+		for(size_t x = h & (table.size()-1);;x = (x+1) & (table.size()-1))
+		{
+			Slot & t = table[x];
+			if(!t.value)
+			{
+				if(!t.erased)
+				{
+					if(!free) free = &t;
+					free->hash = h;
+					return *free;
+				};
+				if(!free) free = &t;
+			}
+			else if(t.hash == h && matches(t.value,s,b,e))
+			{
+				return t;
+			};
+		};
+	};
+
+	/* the slot holding the instance, or 0, without changing the table */
+	template<typename TI>
+	Slot * lookup(const S * s,TI b,TI e)
+	{
+		if(table.empty()) return 0;
+		const size_t h = hashOf(s,b,e);
+		for(size_t x = h & (table.size()-1);;x = (x+1) & (table.size()-1))
+		{
+			Slot & t = table[x];
+			if(!t.value)
+			{
+				if(!t.erased) return 0;
+			}
+			else if(t.hash == h && matches(t.value,s,b,e))
+			{
+				return &t;
+			};
+		};
+	};
+
 public:
+	GenStore() : used(0) {};
 	
 	void write(ostream & o) const
 	{
@@ -363,33 +479,32 @@ public:
 
 	V * insert(V * lit)
 	{
-		V * & str = literals[purify(lit->getHead())].forceGet(lit->begin(),lit->end());
+		Slot & t = slot(purify(lit->getHead()),lit->begin(),lit->end());
 
-		if(str == 0)
+		if(t.value == 0)
 		{
-			str = lit;
+			if(!t.erased) ++used;
+			t.value = lit;
+			t.erased = false;
 			allLits.push_back(lit);
+			contents[purify(lit->getHead())].push_back(lit);
 			lit->setID(allLits.size()-1);
 			return 0;
 		}
-		return str;
+		return t.value;
 	};
 	
 	V * find(V * lit)
 	{
-		V * & str = literals[purify(lit->getHead())].myGet(lit->begin(),lit->end());
-		return str;
+		Slot * t = lookup(purify(lit->getHead()),lit->begin(),lit->end());
+		return t ? t->value : 0;
 	};
 
 	set<V *> allContents(const S * p)
 	{
 		set<V *> slits;
-		for(typename CascadeMap<VAL::const_symbol *,V>::iterator i = literals[purify(p)].begin();
-				i != literals[purify(p)].end();++i)
-		{
-			slits.insert(*i);
-		};
-		slits.erase((V*)0);
+		typename ContentMap::const_iterator c = contents.find(purify(p));
+		if(c != contents.end()) slits.insert(c->second.begin(),c->second.end());
 		return slits;
 	};
 
@@ -406,19 +521,29 @@ public:
 	template<typename TI>
 	V * get(S * s,TI b,TI e)
 	{
-		return literals[purify(s)].get(b,e);
+		Slot * t = lookup(purify(s),b,e);
+		return t ? t->value : 0;
 	};
 
 	template<typename TI>
 	V * find(S * s,TI b,TI e)
 	{
-		return literals[purify(s)].myGet(b,e);
+		Slot * t = lookup(purify(s),b,e);
+		return t ? t->value : 0;
 	};
 	
 	void erase(const V * v)
 	{
-		literals[purify(v->getHead())].myGet(v->begin(),v->end()) = 0;
+		V * w = const_cast<V *>(v);
+		Slot * t = lookup(purify(w->getHead()),w->begin(),w->end());
+		if(t)
+		{
+			t->value = 0;
+			t->erased = true;
+		};
 		allLits[v->getID()] = 0;
+		vector<V *> & c = contents[purify(w->getHead())];
+		c.erase(std::remove(c.begin(),c.end(),w),c.end());
 	}
 
 	void clearUp()
@@ -426,6 +551,14 @@ public:
 		allLits.erase(std::remove(allLits.begin(),allLits.end(),((V*)0)),allLits.end());
 	}
         
+	void swap(GenStore & g)
+	{
+		table.swap(g.table);
+		std::swap(used,g.used);
+		allLits.swap(g.allLits);
+		contents.swap(g.contents);
+	}
+
         void clear()
         {
             iterator itr = begin();
@@ -433,9 +566,21 @@ public:
             
             for (; itr != itrEnd; ++itr) delete *itr;
             
-            literals.clear();
+            table.clear();
+            used = 0;
             allLits.clear();
+            contents.clear();
         }
+
+	// Empty the store without deleting its values, for values that
+	// are released with the arena they were taken from.
+	void drop()
+	{
+		vector<Slot>().swap(table);
+		used = 0;
+		deque<V *>().swap(allLits);
+		ContentMap().swap(contents);
+	}
 };
 
 typedef GenStore<VAL::pred_symbol,Literal> LiteralStore;
@@ -472,6 +617,15 @@ public:
 
 typedef PrimitiveEvaluatorConstructor<LitStoreEvaluator> LSE;
 
+/* totals over all calls to instantiatedOp::instantiate */
+struct GroundingStats {
+	long candidates;	// bindings allowed by the parameter domains
+	long pruned;		// partial bindings falsifying a static precondition
+	long evaluated;		// complete bindings passed to the evaluator
+
+	GroundingStats() : candidates(0), pruned(0), evaluated(0) {};
+};
+
 class instantiatedOp {
 private:
 	int id;
@@ -496,12 +650,30 @@ private:
 	static LiteralStore & literals;
 	static PNEStore & pnes;
 
+	friend struct InstantiationState;
+
 public:
 	instantiatedOp(const VAL::operator_ * o,VAL::FastEnvironment * e) : id(0), op(o), env(e) {};
+	static void * operator new(size_t size) {return VAL::Arena::allocate(size);};
+	static void operator delete(void * p) {VAL::Arena::deallocate(p);};
 	static void instantiate(const VAL::operator_ * op, const VAL::problem * p,VAL::TypeChecker & tc);
+	static GroundingStats groundingStats;
+
+	/* Grounding several schemas at once: prepareInstantiate each schema in
+	 * turn, instantiate each into its own store, then merge the stores in
+	 * schema order to number the operators as a serial grounding would.
+	 */
+	static void prepareInstantiate(const VAL::operator_ * op,VAL::TypeChecker & tc);
+	/* Cache the values of the quantified variables of a goal evaluated
+	 * while schemas are grounded in parallel. */
+	static void prepareEvaluate(const VAL::goal * g,VAL::TypeChecker & tc);
+	static void instantiate(const VAL::operator_ * op, const VAL::problem * p,VAL::TypeChecker & tc,
+							OpStore & ops,GroundingStats & stats);
+	static void mergeOps(OpStore & ops,const GroundingStats & stats);
 	~instantiatedOp() {delete env;};
 
 	static void filterOps(VAL::TypeChecker * const);
+	static void filterOps(const vector<bool> & keep);
 	static void opErase(const instantiatedOp * o)
 	{
 		instOps.erase(o);
@@ -759,6 +931,8 @@ private:
 
 public:
 	instantiatedDrv(const VAL::derivation_rule * o,VAL::FastEnvironment * e) : id(0), op(o), env(e), localHead(o->get_head()->head,o) {};
+	static void * operator new(size_t size) {return VAL::Arena::allocate(size);};
+	static void operator delete(void * p) {VAL::Arena::deallocate(p);};
 	static void instantiate(const VAL::derivation_rule * op, const VAL::problem * p,VAL::TypeChecker & tc);
 	~instantiatedDrv() {delete env;};
 
@@ -825,10 +999,40 @@ public:
 	void setID(int x) {id = x;};
 
 	friend class Collector;
+	friend struct InstantiationState;
 
 
 };
 
+/* The grounding of one problem. The grounding methods work on static
+ * stores, so a program planning several problems keeps a state for each
+ * and swaps it in while working on that problem.
+ *
+ * While a state is swapped in its arena is current, so the parse tree,
+ * operators, literals, PNEs and environments created for the problem are
+ * taken from it and clearing the state releases them all at once.
+ */
+struct InstantiationState {
+	VAL::Arena arena;
+	VAL::Arena * swappedArena;
+
+	InstantiationState() : swappedArena(&arena) {};
+
+	OpStore ops;
+	DrvStore drvs;
+	LiteralStore literals;
+	PNEStore pnes;
+	GroundingStats stats;
+	map<VAL::pddl_type *,vector<VAL::const_symbol*> > values;
+	IState initState;
+	IState0Arity init0State;
+
+	/* exchange this state with the one used by the static methods */
+	void swap();
+
+	/* release the grounded instances held by this state */
+	void clear();
+};
 
 
 ostream & operator<<(ostream & o,const instantiatedOp & io);
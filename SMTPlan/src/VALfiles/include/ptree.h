@@ -57,6 +57,7 @@
 #include "sStack.h"
 #include "macros.h"
 #include "parse_error.h"
+#include "Arena.h"
 #include <iostream>
 
 
@@ -220,6 +221,12 @@ extern analysis* current_analysis;
 /*---------------------------------------------------------------------------*
   ---------------------------------------------------------------------------*/
 
+/* Nodes created while parsing are allocated from the current arena, as
+ * a parse creates very many small nodes that all live as long as the
+ * problem. Deleting an arena node is a no-op, and the tree is released
+ * with the arena. With no current arena, or outside parsing, nodes come
+ * from the heap as usual.
+ */
 class parse_category
 {
 protected:
@@ -227,6 +234,11 @@ protected:
 public:
     parse_category() {};
     virtual ~parse_category() {};
+    static void * operator new(size_t size);
+    static void operator delete(void * p);
+    // nodes are taken from the arena between these calls
+    static void beginArena();
+    static void endArena();
     virtual void display(int ind) const;
     virtual void write(ostream & o) const {};
     virtual void visit(VisitController * v) const {};
@@ -242,11 +254,13 @@ ostream & operator <<(ostream  & o,const parse_category & p);
   This is used as a list of pointers to parse category entities.
   ---------------------------------------------------------------------------*/
 
+// The lists and tables of a parse tree take their storage from the
+// current arena too, so that releasing the arena frees the whole tree.
 template<class pc>
-class pc_list : public list<pc>, public parse_category
+class pc_list : public list<pc,ArenaAllocator<pc> >, public parse_category
 {
 private:
-	typedef list<pc> _Base;
+	typedef list<pc,ArenaAllocator<pc> > _Base;
 public:
     virtual ~pc_list();
     virtual void display(int ind) const;
@@ -304,10 +318,10 @@ struct SpecialistSymbolFactory : public SymbolFactory<T> {
 };
 
 template<class symbol_class>
-class symbol_table : public map<string,symbol_class*>
+class symbol_table : public map<string,symbol_class*,std::less<string>,ArenaAllocator<std::pair<const string,symbol_class*> > >
 {
 private:
-	typedef map<string,symbol_class*> _Base;
+	typedef map<string,symbol_class*,std::less<string>,ArenaAllocator<std::pair<const string,symbol_class*> > > _Base;
 	unique_ptr<SymbolFactory<symbol_class> > factory;
 
 public :
@@ -482,10 +496,10 @@ typedef symbol_table<class_symbol> class_symbol_table;
 // - destroying the symbols themselves is responsibility of a symbol_table
 // - hence we don't make it a pc_list.
 template <class symbol_class>
-class typed_symbol_list : public list<symbol_class*>, public parse_category
+class typed_symbol_list : public list<symbol_class*,ArenaAllocator<symbol_class*> >, public parse_category
 {
 private:
-	typedef list<symbol_class*> _Base;
+	typedef list<symbol_class*,ArenaAllocator<symbol_class*> > _Base;
 public:
     typedef typename _Base::iterator iterator;
 	typedef typename _Base::const_iterator const_iterator;
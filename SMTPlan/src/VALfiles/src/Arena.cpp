@@ -0,0 +1,102 @@
+/************************************************************************
+ * Copyright 2008, Strathclyde Planning Group,
+ * Department of Computer and Information Sciences,
+ * University of Strathclyde, Glasgow, UK
+ * http://planning.cis.strath.ac.uk/
+ *
+ * Maria Fox, Richard Howey and Derek Long - VAL
+ * Stephen Cresswell - PDDL Parser
+ *
+ * This file is part of VAL, the PDDL validator.
+ *
+ * VAL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * VAL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with VAL.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ************************************************************************/
+
+#include "Arena.h"
+#include <new>
+
+namespace VAL {
+
+__thread Arena * Arena::current_ = 0;
+
+// Each allocation is preceded by a header naming the arena it came from,
+// or none for the heap, and its size. The header keeps the memory
+// aligned as the heap would.
+struct ArenaHeader {
+	Arena * owner;
+	size_t size;
+};
+
+static const size_t arenaAlign = 16;
+static const size_t arenaHeader = (sizeof(ArenaHeader) + arenaAlign - 1) & ~(arenaAlign - 1);
+static const size_t arenaBlock = 1 << 20;
+
+void * Arena::take(size_t size)
+{
+	if(size_t(end - next) < size)
+	{
+		const size_t block = size > arenaBlock ? size : arenaBlock;
+		blocks.push_back(static_cast<char *>(::operator new(block)));
+		next = blocks.back();
+		end = next + block;
+	};
+	void * p = next;
+	next += size;
+	return p;
+};
+
+void Arena::release()
+{
+	for(vector<char *>::iterator i = blocks.begin();i != blocks.end();++i)
+	{
+		::operator delete(*i);
+	};
+	blocks.clear();
+	next = end = 0;
+};
+
+void Arena::adopt(Arena & other)
+{
+	blocks.insert(blocks.end(),other.blocks.begin(),other.blocks.end());
+	other.blocks.clear();
+	other.next = other.end = 0;
+};
+
+void * Arena::allocate(size_t size,Arena * a)
+{
+	const size_t total = (size + arenaHeader + arenaAlign - 1) & ~(arenaAlign - 1);
+	char * p = static_cast<char *>(a ? a->take(total) : ::operator new(total));
+	ArenaHeader * h = reinterpret_cast<ArenaHeader *>(p);
+	h->owner = a;
+	h->size = total;
+	return p + arenaHeader;
+};
+
+void Arena::deallocate(void * p)
+{
+	if(!p) return;
+	char * b = static_cast<char *>(p) - arenaHeader;
+	ArenaHeader * h = reinterpret_cast<ArenaHeader *>(b);
+	if(!h->owner)
+	{
+		::operator delete(b);
+	}
+	else if(h->owner == current_ && b + h->size == current_->next)
+	{
+		current_->next = b;
+	};
+};
+
+};
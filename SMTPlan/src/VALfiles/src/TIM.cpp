@@ -29,6 +29,12 @@
 #include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "ptree.h"
 #include "FlexLexer.h"
 #include "TypedAnalyser.h"
@@ -69,9 +75,64 @@ TIMAnalyser * TA;
 
 
 
+/* A file mapped into memory for reading, empty if it cannot be read */
+class MappedFile {
+private:
+	int fd;
+	char * addr;
+	size_t length;
+	bool opened;
+public:
+	MappedFile(const char * name) : fd(-1), addr(0), length(0), opened(false)
+	{
+		fd = open(name,O_RDONLY);
+		if(fd < 0) return;
+		opened = true;
+		struct stat st;
+		if(fstat(fd,&st) != 0 || st.st_size == 0) return;
+		void * a = mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+		if(a == MAP_FAILED)
+		{
+			opened = false;
+			return;
+		};
+		addr = static_cast<char *>(a);
+		length = st.st_size;
+	};
+	~MappedFile()
+	{
+		if(addr) munmap(addr,length);
+		if(fd >= 0) close(fd);
+	};
+	bool good() const {return opened;};
+	const char * data() const {return addr;};
+	size_t size() const {return length;};
+};
+
+/* The generated scanner is interactive, so its default input reads the
+ * stream a character at a time. This one fills the scanner's buffer
+ * from a mapped file as far as the scanner asks.
+ */
+class MappedFlexLexer : public yyFlexLexer {
+private:
+	const char * next;
+	const char * end;
+public:
+	MappedFlexLexer(const MappedFile & f) : yyFlexLexer(0,&cout), next(f.data()), end(f.data() + f.size()) {};
+	virtual int LexerInput(char * buf,int max_size)
+	{
+		const int n = std::min<ptrdiff_t>(max_size,end - next);
+		if(n > 0) memcpy(buf,next,n);
+		next += n;
+		return n;
+	};
+};
+
 void performTIMAnalysis(char * argv[])
 {
     current_analysis = new analysis;
+    types_defined = false;
+    types_used = false;
     IDopTabFactory * fac = new IDopTabFactory;
     current_analysis->setFactory(fac);
     current_analysis->pred_tab.replaceFactory<holding_pred_symbol>();
@@ -82,19 +143,17 @@ void performTIMAnalysis(char * argv[])
     unique_ptr<EPSBuilder> eps(new specEPSBuilder<TIMpredSymbol>());
     Associater::buildEPS = std::move(eps);
     
-    ifstream* current_in_stream;
     yydebug=0; // Set to 1 to output yacc trace 
 
-    yfl= new yyFlexLexer;
-
     // Loop over given args
 
+	parse_category::beginArena();
 	for(int i = 0;i < 2;++i)
 	{
 		current_filename= argv[i];
 	//	cout << "File: " << current_filename << '\n';
-		current_in_stream = new ifstream(current_filename);
-		if (current_in_stream->bad())
+		MappedFile current_in_file(current_filename);
+		if (!current_in_file.good())
 		{
 		    // Output a message now
 		    cerr << "Failed to open ";
@@ -113,15 +172,17 @@ void performTIMAnalysis(char * argv[])
 		{
 		    line_no= 1;
 
-		    // Switch the tokeniser to the current input stream
-		    yfl->switch_streams(current_in_stream,&cout);
+		    // A new tokeniser for the current input file
+		    yfl= new MappedFlexLexer(current_in_file);
 		    yyparse();
+		    delete yfl;
+		    yfl= 0;
 
 		    // Output syntax tree
 		    //if (top_thing) top_thing->display(0);
 		}
-		delete current_in_stream;
     }
+	parse_category::endArena();
     // Output the errors from all input files
     if(current_analysis->error_list.errors) {
 	cerr << "Critical Errors Encountered in Domain/Problem File\n";
@@ -131,7 +192,7 @@ void performTIMAnalysis(char * argv[])
     	current_analysis->error_list.report();
 	exit(0);
     } else if (current_analysis->error_list.warnings) {
-        cout << "Warnings encountered when parsing Domain/Problem File\n";
+        cerr << "Warnings encountered when parsing Domain/Problem File\n";
 	cerr << "-----------------------------------------------------\n\n";
         cerr << "The supplied domain/problem file appear to violate part of the PDDL\n";
         cerr << "language specification.  Specifically:\n";
@@ -139,8 +200,6 @@ void performTIMAnalysis(char * argv[])
 	cerr << "\nThe planner will continue, but you may wish to fix your files accordingly\n";
     }
 
-    delete yfl;
-
     DurativeActionPredicateBuilder dapb;
     current_analysis->the_domain->visit(&dapb);
 
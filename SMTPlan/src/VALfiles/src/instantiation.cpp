@@ -227,6 +227,24 @@ void instantiatedOp::filterOps(VAL::TypeChecker * const tc)
 	instOps.clearUp();
 };
 
+void instantiatedOp::filterOps(const vector<bool> & keep)
+{
+	int offset = 0;
+	for(OpStore::iterator i = opsBegin(); !(i == opsEnd());++i)
+	{
+		if(!keep[(*i)->getID()])
+		{
+			opErase(*i);
+			++offset;
+		}
+		else
+		{
+			(*i)->setID((*i)->getID() - offset);
+		};
+	}
+	instOps.clearUp();
+};
+
 void instantiatedDrv::filterDrvs(VAL::TypeChecker * const tc)
 {
 	int offset = 0;
@@ -322,6 +340,105 @@ struct ConstSymbolLT {
 	}
 };
 
+/* Caches the range of the type of a parameter, so that the ranges are only
+ * computed once and can then be read by several threads grounding at once.
+ */
+static void cacheParameterValues(const VAL::operator_ * op,VAL::TypeChecker & tc,VAL::var_symbol * p,int i)
+{
+	if(instantiatedValues.find(p->type) == instantiatedValues.end()) 
+	{
+		try {
+			instantiatedValues[p->type] = tc.range(p);
+		}
+		catch (TypeException e) {			
+
+			cerr << "A problem has been encountered with your domain/problem file.\n";
+			cerr << "-------------------------------------------------------------\n";
+			cerr << "Unfortunately, a type error has been encountered in your domain and problem file,\n";
+			cerr << "and the planner has to terminate.  Specifically, for parameter " << (i+1) << "\n";
+			cerr << "of the action '" << op->name->getName() << "':\n\n\t";
+
+			Verbose = true;
+			try {
+				instantiatedValues[p->type] = tc.range(p);
+			}
+			catch (TypeException f) {
+			}
+			exit(1);
+		}
+	};
+};
+
+/* SimpleEvaluator looks up the values of quantified variables in
+ * instantiatedValues, inserting them if missing. When schemas are
+ * grounded in parallel they must all be present before the threads
+ * start, so every quantified variable of a goal or effect is cached here.
+ */
+class QuantifiedValueCacher : public VAL::VisitController {
+
+private:
+	VAL::TypeChecker & tc;
+
+	void cache(const var_symbol_list * vars)
+	{
+		for(var_symbol_list::const_iterator p = vars->begin();p != vars->end();++p)
+		{
+			if(instantiatedValues.find((*p)->type) != instantiatedValues.end()) continue;
+			try {
+				instantiatedValues[(*p)->type] = tc.range(*p);
+			}
+			catch (TypeException e) {
+				instantiatedValues.erase((*p)->type);
+			}
+		};
+	};
+
+public:
+	QuantifiedValueCacher(VAL::TypeChecker & t) : tc(t) {};
+
+	virtual void visit_qfied_goal(qfied_goal * p)
+	{
+		cache(p->getVars());
+		p->getGoal()->visit(this);
+	};
+	virtual void visit_conj_goal(conj_goal * p)
+	{
+		for(goal_list::const_iterator i = p->getGoals()->begin();i != p->getGoals()->end();++i)
+			(*i)->visit(this);
+	};
+	virtual void visit_disj_goal(disj_goal * p)
+	{
+		for(goal_list::const_iterator i = p->getGoals()->begin();i != p->getGoals()->end();++i)
+			(*i)->visit(this);
+	};
+	virtual void visit_imply_goal(imply_goal * p)
+	{
+		p->getAntecedent()->visit(this);
+		p->getConsequent()->visit(this);
+	};
+	virtual void visit_neg_goal(neg_goal * p) {p->getGoal()->visit(this);};
+	virtual void visit_timed_goal(timed_goal * p) {p->getGoal()->visit(this);};
+
+	virtual void visit_effect_lists(effect_lists * p)
+	{
+		p->forall_effects.visit(this);
+		p->cond_effects.visit(this);
+		p->cond_assign_effects.visit(this);
+		p->timed_effects.visit(this);
+	};
+	virtual void visit_forall_effect(forall_effect * p)
+	{
+		cache(p->getVarsList());
+		p->getEffects()->visit(this);
+	};
+	virtual void visit_cond_effect(cond_effect * p)
+	{
+		p->getCondition()->visit(this);
+		p->getEffects()->visit(this);
+	};
+	virtual void visit_timed_effect(timed_effect * p) {p->effs->visit(this);};
+};
+
 class ParameterDomainConstraints : public VAL::VisitController {
 
 private:
@@ -349,28 +466,7 @@ public:
 			{
 	//			symbols[i] = *p;
 
-				if(instantiatedValues.find((*p)->type) == instantiatedValues.end()) 
-				{
-					try {
-						instantiatedValues[(*p)->type] = tc.range(*p);
-					}
-					catch (TypeException e) {			
-
-						cerr << "A problem has been encountered with your domain/problem file.\n";
-						cerr << "-------------------------------------------------------------\n";
-						cerr << "Unfortunately, a type error has been encountered in your domain and problem file,\n";
-						cerr << "and the planner has to terminate.  Specifically, for parameter " << (i+1) << "\n";
-						cerr << "of the action '" << op->name->getName() << "':\n\n\t";
-
-						Verbose = true;
-						try {
-							instantiatedValues[(*p)->type] = tc.range(*p);
-						}
-						catch (TypeException f) {
-						}
-						exit(1);
-					}
-				};
+				cacheParameterValues(op,tc,*p,i);
 				possibleParameterValues[i].insert(possibleParameterValues[i].end(),instantiatedValues[(*p)->type].begin(),instantiatedValues[(*p)->type].end());
 				vars[i] = *p;
 			};
@@ -678,8 +774,189 @@ public:
 
 };
 
+
+/* Enumerates the bindings of an operator's parameters depth first, last
+ * parameter outermost, so operators are found in the same order as by
+ * counting through the domains. The static preconditions of the operator
+ * are checked as soon as their arguments are bound, and a partial binding
+ * that falsifies one is not extended.
+ */
+class JoinGrounder {
+private:
+	const VAL::operator_ * op;
+	FastEnvironment & e;
+	SimpleEvaluator & se;
+	OpStore & instOps;
+	GroundingStats & stats;
+
+	const vector<VAL::var_symbol *> & vars;
+	const vector<vector<VAL::const_symbol*>::const_iterator > & starts;
+	const vector<vector<VAL::const_symbol*>::const_iterator > & ends;
+
+	// checks[i] are the static goals whose arguments are all bound once
+	// parameter i is bound; checks[n] are those without parameters
+	vector<vector<const VAL::simple_goal *> > checks;
+
+	void collect(const VAL::goal * g)
+	{
+		if(!g) return;
+		if(const VAL::conj_goal * cg = dynamic_cast<const VAL::conj_goal *>(g))
+		{
+			for(VAL::goal_list::const_iterator i = cg->getGoals()->begin();
+					i != cg->getGoals()->end();++i)
+			{
+				collect(*i);
+			};
+			return;
+		};
+		if(const VAL::timed_goal * tg = dynamic_cast<const VAL::timed_goal *>(g))
+		{
+			collect(tg->getGoal());
+			return;
+		};
+		const VAL::simple_goal * sg = dynamic_cast<const VAL::simple_goal *>(g);
+		if(!sg || sg->getProp()->head->getName() == "=") return;
+
+		extended_pred_symbol * eps = EPS(sg->getProp()->head);
+		if(!eps->appearsStatic() && !(eps->cannotIncrease() && sg->getPolarity() != E_NEG)) return;
+
+		int first = vars.size();
+		for(VAL::parameter_symbol_list::const_iterator a = sg->getProp()->args->begin();
+				a != sg->getProp()->args->end();++a)
+		{
+			if(!dynamic_cast<const VAL::var_symbol *>(*a)) continue;
+			vector<VAL::var_symbol *>::const_iterator v = std::find(vars.begin(),vars.end(),*a);
+			if(v == vars.end()) return;
+			first = std::min(first,(int)(v - vars.begin()));
+		};
+		checks[first].push_back(sg);
+	};
+
+	/* false only if the evaluator would find the goal false */
+	bool holds(const VAL::simple_goal * sg)
+	{
+		extended_pred_symbol * eps = EPS(sg->getProp()->head);
+		if(eps->appearsStatic() && !eps->isCompletelyStatic(&e,sg->getProp())) return true;
+
+		bool value = eps->contains(&e,sg->getProp())
+				|| (InitialStateEvaluator::init0State.find(sg->getProp()->head) != InitialStateEvaluator::init0State.end());
+		if(sg->getPolarity() == E_NEG) value = !value;
+		return value;
+	};
+
+	bool holdsAll(int i)
+	{
+		for(vector<const VAL::simple_goal *>::const_iterator g = checks[i].begin();
+				g != checks[i].end();++g)
+		{
+			if(!holds(*g)) return false;
+		};
+		return true;
+	};
+
+	void ground()
+	{
+		++stats.evaluated;
+		if(TIM::selfMutex(op,makeIterator(&e,op->parameters->begin()),
+						makeIterator(&e,op->parameters->end()))) return;
+
+		se.prepareForVisit(&e);
+		const_cast<VAL::operator_*>(op)->visit(&se);
+		if(se.reallyFalse()) return;
+
+		FastEnvironment * ecpy = e.copy();
+		instantiatedOp * o = new instantiatedOp(op,ecpy);
+		if(instOps.insert(o))
+		{
+			delete o;
+		};
+	};
+
+	void ground(int i)
+	{
+		if(i < 0)
+		{
+			ground();
+			return;
+		};
+		for(vector<VAL::const_symbol*>::const_iterator v = starts[i];v != ends[i];++v)
+		{
+			e[vars[i]] = *v;
+			if(!holdsAll(i))
+			{
+				++stats.pruned;
+				continue;
+			};
+			ground(i-1);
+		};
+	};
+
+public:
+	JoinGrounder(const VAL::operator_ * o,FastEnvironment & env,SimpleEvaluator & s,OpStore & ops,GroundingStats & gs,
+				const vector<VAL::var_symbol *> & vs,
+				const vector<vector<VAL::const_symbol*>::const_iterator > & ss,
+				const vector<vector<VAL::const_symbol*>::const_iterator > & es) :
+		op(o), e(env), se(s), instOps(ops), stats(gs), vars(vs), starts(ss), ends(es),
+		checks(vs.size()+1)
+	{
+		collect(op->precondition);
+	};
+
+	void ground_all()
+	{
+		if(!holdsAll(vars.size()))
+		{
+			++stats.pruned;
+			return;
+		};
+		ground(vars.size()-1);
+	};
+};
+
+GroundingStats instantiatedOp::groundingStats;
 	
 void instantiatedOp::instantiate(const VAL::operator_ * op,const VAL::problem * prb,VAL::TypeChecker & tc)
+{
+	instantiate(op,prb,tc,instOps,groundingStats);
+};
+
+void instantiatedOp::prepareInstantiate(const VAL::operator_ * op,VAL::TypeChecker & tc)
+{
+	int i = 0;
+	for(var_symbol_list::const_iterator p = op->parameters->begin();
+			p != op->parameters->end();++p,++i)
+	{
+		cacheParameterValues(op,tc,*p,i);
+	};
+	QuantifiedValueCacher qvc(tc);
+	if(op->precondition) op->precondition->visit(&qvc);
+	if(op->effects) op->effects->visit(&qvc);
+	TIM::MutexStore * tm = MEX(const_cast<VAL::operator_ *>(op));
+	if(tm) tm->getMutex(const_cast<VAL::operator_ *>(op));
+};
+
+void instantiatedOp::prepareEvaluate(const VAL::goal * g,VAL::TypeChecker & tc)
+{
+	QuantifiedValueCacher qvc(tc);
+	if(g) g->visit(&qvc);
+};
+
+void instantiatedOp::mergeOps(OpStore & ops,const GroundingStats & stats)
+{
+	for(OpStore::iterator i = ops.begin();i != ops.end();++i)
+	{
+		if(instOps.insert(*i))
+		{
+			delete *i;
+		};
+	};
+	groundingStats.candidates += stats.candidates;
+	groundingStats.pruned += stats.pruned;
+	groundingStats.evaluated += stats.evaluated;
+};
+
+void instantiatedOp::instantiate(const VAL::operator_ * op,const VAL::problem * prb,VAL::TypeChecker & tc,
+									OpStore & ops,GroundingStats & stats)
 {
 	FastEnvironment e(static_cast<const id_var_symbol_table*>(op->symtab)->numSyms());
 
@@ -693,6 +970,7 @@ void instantiatedOp::instantiate(const VAL::operator_ * op,const VAL::problem *
 
 	int c = 1;
 	pdc.fleshOut(vals,starts,ends,c);
+	stats.candidates += c;
 
 	vector<VAL::var_symbol *> vars(opParamCount);
 
@@ -708,13 +986,14 @@ void instantiatedOp::instantiate(const VAL::operator_ * op,const VAL::problem *
 	SimpleEvaluator se(&tc,0,ISC());
 	if(!i)
 	{
+		++stats.evaluated;
 		se.prepareForVisit(&e);
 		op->visit(&se);
 		if(!se.reallyFalse())
 		{
 			FastEnvironment * ecpy = e.copy();
 			instantiatedOp * o = new instantiatedOp(op,ecpy);
-			if(instOps.insert(o))
+			if(ops.insert(o))
 			{
 				delete o;
 			};
@@ -722,49 +1001,8 @@ void instantiatedOp::instantiate(const VAL::operator_ * op,const VAL::problem *
 		};
 		return;
 	};
-	--i;
-	while(vals[i] != ends[i])
-	{
-		if(!TIM::selfMutex(op,makeIterator(&e,op->parameters->begin()),
-						makeIterator(&e,op->parameters->end())))
-		{
-			
-			se.prepareForVisit(&e);
-			const_cast<VAL::operator_*>(op)->visit(&se);
-			if(!se.reallyFalse())
-			{
-				FastEnvironment * ecpy = e.copy();
-				instantiatedOp * o = new instantiatedOp(op,ecpy);
-				if(instOps.insert(o))
-				{
-					delete o;
-				};
-			}
-			else if (false)
-			{
-				cout << "Killed\n" << op->name->getName() << "(";
-				for(var_symbol_list::const_iterator a = op->parameters->begin();
-						a != op->parameters->end();++a)
-				{
-					cout << e[*a]->getName() << " ";
-				};
-				cout << ")\n";
-			};
-
-		};
-
-		int x = 0;
-		++vals[0];
-		if(vals[0] != ends[0]) e[vars[0]] = *(vals[0]);
-		while(x < i && vals[x] == ends[x])
-		{
-			vals[x] = starts[x];
-			e[vars[x]] = *(vals[x]);
-			++x;
-			++vals[x];
-			if(vals[x] != ends[x]) e[vars[x]] = *(vals[x]);
-		};
-	};
+	JoinGrounder grounder(op,e,se,ops,stats,vars,starts,ends);
+	grounder.ground_all();
 };
 
 void instantiatedDrv::instantiate(const VAL::derivation_rule * op,const VAL::problem * prb,VAL::TypeChecker & tc)
@@ -884,6 +1122,32 @@ PNEStore & instantiatedOp::pnes = instantiatedPNEs;
 LiteralStore & instantiatedDrv::literals = instantiatedLiterals;
 PNEStore & instantiatedDrv::pnes = instantiatedPNEs;
 
+void InstantiationState::swap()
+{
+	instantiatedOp::instOps.swap(ops);
+	instantiatedDrv::instDrvs.swap(drvs);
+	instantiatedLiterals.swap(literals);
+	instantiatedPNEs.swap(pnes);
+	std::swap(instantiatedOp::groundingStats,stats);
+	instantiatedValues.swap(values);
+	InitialStateEvaluator::initState.swap(initState);
+	InitialStateEvaluator::init0State.swap(init0State);
+	swappedArena = Arena::setCurrent(swappedArena);
+};
+
+void InstantiationState::clear()
+{
+	ops.drop();
+	drvs.drop();
+	literals.drop();
+	pnes.drop();
+	stats = GroundingStats();
+	values.clear();
+	initState.clear();
+	init0State.clear();
+	arena.release();
+};
+
 
 class Collector : public VisitController {
 private:
@@ -1088,9 +1352,9 @@ public:
 	virtual void visit_effect_lists(effect_lists * p) 
 	{
 		p->add_effects.pc_list<simple_effect*>::visit(this);
-		p->forall_effects.pc_list<forall_effect*>::visit(this);
-		p->cond_effects.pc_list<cond_effect*>::visit(this);
-		p->timed_effects.pc_list<timed_effect*>::visit(this);
+		p->forall_effects.visit(this);
+		p->cond_effects.visit(this);
+		p->timed_effects.visit(this);
 		bool whatwas = adding;
 		adding = !adding;
 		p->del_effects.pc_list<simple_effect*>::visit(this);
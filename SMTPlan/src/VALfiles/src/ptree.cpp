@@ -43,6 +43,7 @@
 #include "ptree.h"
 #include "macros.h"
 #include "DebugWriteController.h"
+#include "Arena.h"
 #include "VisitController.h"
 #include <memory>
 
@@ -61,6 +62,23 @@ WriteController * parse_category::recoverWriteController()
 
 void parse_category::setWriteController(unique_ptr<WriteController> w) {wcntr = std::move(w);};
 
+// Nodes are taken from the thread's current arena, so a program that
+// keeps an arena for each problem releases its parse tree with it.
+static bool parseArenaActive = false;
+
+void * parse_category::operator new(size_t size)
+{
+	return Arena::allocate(size,parseArenaActive ? Arena::current() : 0);
+};
+
+void parse_category::operator delete(void * p)
+{
+	Arena::deallocate(p);
+};
+
+void parse_category::beginArena() {parseArenaActive = true;};
+void parse_category::endArena() {parseArenaActive = false;};
+
 void parse_category::display(int ind) const
 {
     TITLE(parse_category);
@@ -0,0 +1,53 @@
+#include "SMTPlan/VariableFactory.h"
+
+/* implementation of SMTPlan::VariableFactory */
+namespace SMTPlan {
+
+	int VariableFactory::addPrefix(const std::string &prefix) {
+		prefixes.push_back(prefix);
+		return prefixes.size() - 1;
+	}
+
+	z3::expr VariableFactory::mk_bool(int prefix, int h, const char * suffix) {
+		return context->constant(mk_symbol(prefix, h, -1, suffix), context->bool_sort());
+	}
+
+	z3::expr VariableFactory::mk_real(int prefix, int h, const char * suffix) {
+		return context->constant(mk_symbol(prefix, h, -1, suffix), context->real_sort());
+	}
+
+	z3::expr VariableFactory::mk_cascade_bool(int prefix, int h, int b) {
+		return context->constant(mk_symbol(prefix, h, b, ""), context->bool_sort());
+	}
+
+	z3::expr VariableFactory::mk_cascade_real(int prefix, int h, int b) {
+		return context->constant(mk_symbol(prefix, h, b, ""), context->real_sort());
+	}
+
+	/**
+	 * The symbol of a constant is its index in the variables table,
+	 * so no string is built unless readable names were asked for.
+	 */
+	z3::symbol VariableFactory::mk_symbol(int prefix, int h, int b, const char * suffix) {
+		VariableName var = {prefix, h, b, suffix};
+		variables.push_back(var);
+		if(readable) return context->str_symbol(mk_name(var).c_str());
+		return context->int_symbol(variables.size() - 1);
+	}
+
+	std::string VariableFactory::mk_name(const VariableName &var) const {
+		std::stringstream ss;
+		ss << prefixes[var.prefix] << var.h;
+		if(var.b >= 0) ss << "_" << var.b;
+		else ss << var.suffix;
+		return ss.str();
+	}
+
+	std::string VariableFactory::name(const z3::expr &var) const {
+		z3::symbol sym = var.decl().name();
+		if(sym.kind() == Z3_INT_SYMBOL && sym.to_int() < (int)variables.size())
+			return mk_name(variables[sym.to_int()]);
+		return sym.str();
+	}
+
+} // close namespace